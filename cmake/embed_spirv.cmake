@@ -0,0 +1,36 @@
+# Converts a compiled SPIR-V module into a C++ array of 32-bit words, so it is already
+# aligned for vkCreateShaderModule.
+#
+# Usage: cmake -DINPUT=shader.spv -DOUTPUT=shader.cpp -DSYMBOL=name -P embed_spirv.cmake
+
+file(READ ${INPUT} contents HEX)
+
+string(LENGTH "${contents}" hex-length)
+math(EXPR remainder "${hex-length} % 8")
+if(hex-length EQUAL 0 OR NOT remainder EQUAL 0)
+	message(FATAL_ERROR "${INPUT} is not a whole number of 32-bit SPIR-V words")
+endif()
+
+# glslc writes words little endian; reassemble them so the values match on any host.
+string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1u, " words "${contents}")
+# CMake regexes have no {n}, so spell out eight words per line
+set(line-pattern "")
+foreach(word RANGE 1 8)
+	string(APPEND line-pattern "0x[0-9a-f]+u, ")
+endforeach()
+string(REGEX REPLACE "(${line-pattern})" "\\1\n        " words "${words}")
+string(REPLACE ", \n" ",\n" words "${words}")
+string(STRIP "${words}" words)
+
+file(WRITE ${OUTPUT}
+"// Generated from ${INPUT} by embed_spirv.cmake, do not edit
+#include <cstddef>
+#include <cstdint>
+
+namespace triangle {
+    extern const uint32_t ${SYMBOL}[] = {
+        ${words}
+    };
+    extern const size_t ${SYMBOL}_size = sizeof(${SYMBOL});
+}
+")
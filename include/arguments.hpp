@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace triangle {
+    // Parses a numeric command line value. Unlike calling std::sto* directly, trailing garbage,
+    // negative values for unsigned types and out of range values are rejected, and the
+    // offending flag is reported before exiting rather than escaping as an uncaught exception.
+    template<typename T>
+    T parseArgument(const std::string& flag, const std::string& value){
+        static_assert(std::is_arithmetic_v<T>, "Only numeric arguments can be parsed");
+
+        try {
+            size_t end = 0;
+
+            if constexpr (std::is_floating_point_v<T>){
+                long double parsed = std::stold(value, &end);
+                if (end == value.size() && parsed >= std::numeric_limits<T>::lowest() && parsed <= std::numeric_limits<T>::max()){
+                    return static_cast<T>(parsed);
+                }
+            }
+            else if constexpr (std::is_signed_v<T>){
+                long long parsed = std::stoll(value, &end);
+                if (end == value.size() && parsed >= std::numeric_limits<T>::min() && parsed <= std::numeric_limits<T>::max()){
+                    return static_cast<T>(parsed);
+                }
+            }
+            else {
+                // std::stoull silently wraps a leading minus sign
+                unsigned long long parsed = std::stoull(value, &end);
+                if (end == value.size() && value.find('-') == std::string::npos && parsed <= std::numeric_limits<T>::max()){
+                    return static_cast<T>(parsed);
+                }
+            }
+        }
+        catch (const std::logic_error&) {
+            // std::invalid_argument and std::out_of_range, reported below
+        }
+
+        std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+namespace triangle {
+    // Creates each distinct descriptor set layout once. Layouts are keyed by their bindings,
+    // so callers can ask for a layout wherever they need it instead of threading handles
+    // around. The cache owns the layouts and destroys them with itself.
+    class DescriptorLayoutCache {
+        public:
+            explicit DescriptorLayoutCache(VkDevice device);
+            ~DescriptorLayoutCache();
+
+            DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+            DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+            // Binding order does not matter; bindings are sorted before lookup
+            VkDescriptorSetLayout get(std::vector<VkDescriptorSetLayoutBinding> bindings);
+
+            size_t size() const;
+
+            // For each descriptor type, the most descriptors of it any cached layout uses. A pool
+            // reserving this many per set fits that many sets of any cached layout.
+            std::vector<VkDescriptorPoolSize> getDescriptorsPerSet() const;
+
+        private:
+            struct Key {
+                std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+                bool operator==(const Key& other) const;
+            };
+
+            struct KeyHasher {
+                size_t operator()(const Key& key) const;
+            };
+
+            VkDevice device;
+
+            std::unordered_map<Key, VkDescriptorSetLayout, KeyHasher> layouts;
+            std::vector<VkDescriptorPoolSize> descriptorsPerSet;
+            mutable std::mutex mutex;
+    };
+
+    // Hands out descriptor sets that live for one frame. Each frame in flight owns the pools
+    // it allocated from; once that frame's submission has completed, beginFrame() resets them
+    // wholesale and they go back on the free list, so sets are never freed one by one and
+    // pools never fragment. When a pool runs out another is taken, growing the pool size.
+    //
+    // Pools are sized from the layouts in the cache, so every layout passed to allocate() must
+    // come from it. Pools created before a layout with new descriptor types was added are
+    // destroyed rather than reused.
+    //
+    // Not thread-safe: allocate from the thread that records the frame.
+    class DescriptorAllocator {
+        public:
+            struct Stats {
+                uint64_t setsAllocated = 0;
+                uint32_t poolsCreated = 0;
+                uint64_t poolResets = 0;
+            };
+
+            DescriptorAllocator(
+                VkDevice device,
+                const DescriptorLayoutCache& layoutCache,
+                uint32_t frameCount,
+                uint32_t initialSetsPerPool = 256
+            );
+            ~DescriptorAllocator();
+
+            DescriptorAllocator(const DescriptorAllocator&) = delete;
+            DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+            // Recycles every pool the frame slot used; its previous submission must have completed
+            void beginFrame(uint32_t frameIndex);
+
+            VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+            Stats getStats() const;
+
+        private:
+            struct Pool {
+                VkDescriptorPool handle;
+                // Value of poolGeneration when the pool was created
+                uint32_t generation;
+            };
+
+            Pool acquirePool();
+
+            VkDevice device;
+            const DescriptorLayoutCache& layoutCache;
+            uint32_t setsPerPool;
+
+            // Descriptors per set the current pools were sized for, and how often that changed
+            std::vector<VkDescriptorPoolSize> descriptorsPerSet;
+            uint32_t poolGeneration;
+
+            // Pools in use by each frame slot; the last one is allocated from
+            std::vector<std::vector<Pool>> framePools;
+            uint32_t currentFrame;
+
+            std::vector<Pool> freePools;
+
+            Stats stats;
+    };
+}
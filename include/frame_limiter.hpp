@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <frame_stats.hpp>
+
+namespace triangle {
+    // Holds a render loop to a fixed frame interval. Each wait sleeps on the OS timer until
+    // shortly before the deadline and spins through the rest, since timer wakeups can be late
+    // by a millisecond or more. The spin margin follows how late the timer has been waking up.
+    class FrameLimiter {
+        public:
+            struct Stats {
+                uint64_t frames = 0;
+                double sleepMs = 0.0;
+                double spinMs = 0.0;
+                // Frames that started more than a full interval late, after which the schedule
+                // restarts instead of rushing frames out to catch up
+                uint64_t missedDeadlines = 0;
+            };
+
+            FrameLimiter();
+
+            // Minimum time between frame starts; 0 or less lets frames start immediately
+            void setInterval(double intervalMs);
+            double getInterval() const;
+
+            // Blocks until the next frame is due and returns how long that took
+            double wait();
+
+            double getSpinMargin() const;
+            Stats getStats() const;
+
+        private:
+            double intervalMs;
+            // Start of the next frame, valid once started is set
+            FrameClock::time_point deadline;
+            bool started;
+
+            double spinMarginMs;
+
+            Stats stats;
+    };
+}
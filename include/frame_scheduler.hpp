@@ -0,0 +1,53 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+namespace triangle {
+    // Paces frames in flight with a single timeline semaphore. Frame n's submission signals
+    // the value n + 1, so the counter doubles as a clock of GPU progress: anything last used
+    // by a frame whose value has been reached is free to reuse or destroy.
+    class FrameScheduler {
+        public:
+            struct Stats {
+                // Frames whose slot was still busy when they began, and the time spent waiting
+                uint64_t stalls = 0;
+                double waitMs = 0.0;
+            };
+
+            FrameScheduler(VkDevice device, uint32_t framesInFlight);
+            ~FrameScheduler();
+
+            FrameScheduler(const FrameScheduler&) = delete;
+            FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+            // Blocks until the submission that last used the next frame's slot has completed and
+            // returns that slot. Calling it again without submitting returns the same slot.
+            uint32_t beginFrame();
+
+            // Value the frame being recorded signals; pass it to the submission
+            uint64_t getFrameValue() const;
+            // Records that the frame has been submitted with its value as the signal
+            void endFrame();
+
+            // Highest value submitted so far and highest value the GPU has reached
+            uint64_t getSubmittedValue() const;
+            uint64_t getCompletedValue();
+
+            void wait(uint64_t value);
+
+            VkSemaphore getSemaphore() const;
+            Stats getStats() const;
+
+        private:
+            VkDevice device;
+            VkSemaphore semaphore;
+            uint32_t framesInFlight;
+
+            uint64_t submittedValue;
+            // Last value read back, so repeated queries within a frame skip the driver call
+            uint64_t completedValue;
+
+            Stats stats;
+    };
+}
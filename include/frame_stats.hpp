@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace triangle {
+    using FrameClock = std::chrono::steady_clock;
+
+    inline double elapsedMilliseconds(FrameClock::time_point start, FrameClock::time_point end = FrameClock::now()){
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // CPU-side timings of a single drawFrame() call, in milliseconds
+    struct FrameTimings {
+        double cpuFrameMs = 0.0;
+        double acquireWaitMs = 0.0;
+        // Waiting for the frame slot's previous submission on the frame timeline
+        double fenceWaitMs = 0.0;
+        double presentMs = 0.0;
+        // Waiting for the previous frame to be displayed (low latency pacing only)
+        double presentWaitMs = 0.0;
+        double recordMs = 0.0;
+        // Slept by the frame limiter before the frame began, outside cpuFrameMs
+        double limiterWaitMs = 0.0;
+
+        // Estimated input-to-present latency of an earlier frame, from its start (input is
+        // polled just before) until it was displayed as reported by present wait, or else until
+        // its rendering was seen to complete. Negative if none was measured this frame.
+        double latencyMs = -1.0;
+
+        // Rebuilding the render targets after a resize at the end of this frame, or negative
+        // if they were not rebuilt
+        double recreateMs = -1.0;
+
+        // GPU render pass time collected while this frame ran (from an earlier
+        // submission that had completed), or negative if none was ready
+        double gpuRenderPassMs = -1.0;
+    };
+
+    class FrameStats {
+        public:
+            struct Percentiles {
+                double p50;
+                double p95;
+                double p99;
+                double max;
+            };
+
+            void record(const FrameTimings& timings);
+            void record(const std::string& series, double value);
+            void clear();
+
+            size_t frameCount() const;
+            const std::vector<double>& samples(const std::string& series) const;
+            bool hasSamples(const std::string& series) const;
+
+            static Percentiles computePercentiles(std::vector<double> values);
+
+            // Fraction of the shorter of total CPU work and total GPU time that ran concurrently
+            // with the other (0 when fully serialized, 1 when one is completely hidden), or
+            // negative if there were no GPU timings to compare against
+            double cpuGpuOverlap() const;
+
+            // Emits {"<series>": {"p50": .., "p95": .., "p99": .., "max": ..}, ...} plus any extra fields
+            void writeJson(std::ostream& out, const std::map<std::string, std::string>& fields = {}) const;
+
+        private:
+            std::map<std::string, std::vector<double>> series;
+            size_t frames = 0;
+    };
+}
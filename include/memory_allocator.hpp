@@ -0,0 +1,126 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+namespace triangle {
+    // Linear resources (buffers, linear images) and optimal-tiling images are kept in
+    // separate blocks so bufferImageGranularity never has to be honoured between them
+    enum class ResourceKind {
+        Linear,
+        Optimal
+    };
+
+    // A sub-range of a larger VkDeviceMemory block owned by a MemoryAllocator
+    struct Allocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        // Non-null when the memory type is host-visible; blocks stay mapped while they live
+        void* mappedData = nullptr;
+
+        // Bookkeeping used to return the range to its block
+        void* block = nullptr;
+        uint32_t order = 0;
+    };
+
+    // Sub-allocates every buffer and image from large per-memory-type blocks using a
+    // buddy allocator, so the device sees a handful of vkAllocateMemory calls instead
+    // of one per resource.
+    class MemoryAllocator {
+        public:
+            struct Stats {
+                // Live VkDeviceMemory objects and the bytes they hold
+                uint32_t blockCount = 0;
+                VkDeviceSize bytesAllocated = 0;
+
+                // Live sub-allocations, the bytes requested for them and the bytes they
+                // actually occupy once rounded up to a buddy size
+                uint64_t allocationCount = 0;
+                VkDeviceSize bytesUsed = 0;
+                VkDeviceSize bytesReserved = 0;
+
+                // Largest single free range across all blocks, and 1 - largest / total free
+                // (0 means all free space is contiguous)
+                VkDeviceSize largestFreeRange = 0;
+                double fragmentation = 0.0;
+
+                uint64_t totalAllocations = 0;
+                uint64_t totalFrees = 0;
+            };
+
+            MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = 64 * 1024 * 1024);
+            ~MemoryAllocator();
+
+            MemoryAllocator(const MemoryAllocator&) = delete;
+            MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+            Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind);
+            void free(Allocation& allocation);
+
+            // Create a resource and bind it to a fresh sub-allocation
+            void createBuffer(
+                const VkBufferCreateInfo& bufferInfo,
+                VkMemoryPropertyFlags properties,
+                VkBuffer& buffer,
+                Allocation& allocation
+            );
+            void createImage(
+                const VkImageCreateInfo& imageInfo,
+                VkMemoryPropertyFlags properties,
+                VkImage& image,
+                Allocation& allocation
+            );
+            void destroyBuffer(VkBuffer buffer, Allocation& allocation);
+            void destroyImage(VkImage image, Allocation& allocation);
+
+            uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+            Stats getStats() const;
+
+        private:
+            // Smallest buddy size; every allocation is rounded up to a power of two above this
+            static constexpr VkDeviceSize minimumAllocation = 256;
+
+            struct Block {
+                VkDeviceMemory memory;
+                VkDeviceSize size;
+                char* mappedData;
+                uint32_t poolKey;
+                uint32_t maxOrder;
+
+                // Free offsets for each order, where order k covers minimumAllocation << k bytes
+                std::vector<std::set<VkDeviceSize>> freeLists;
+
+                uint64_t allocationCount;
+                VkDeviceSize bytesUsed;
+                VkDeviceSize bytesReserved;
+            };
+
+            std::unique_ptr<Block> createBlock(uint32_t poolKey, uint32_t memoryTypeIndex, VkDeviceSize size);
+            void destroyBlock(Block* block);
+            bool allocateFromBlock(Block* block, uint32_t order, VkDeviceSize& offset);
+            void freeToBlock(Block* block, VkDeviceSize offset, uint32_t order);
+
+            static uint32_t orderForSize(VkDeviceSize size);
+
+            VkDevice device;
+            VkPhysicalDeviceMemoryProperties memoryProperties;
+            uint32_t maxAllocationCount;
+            VkDeviceSize blockSize;
+
+            // Keyed by memory type index * 2 + (optimal ? 1 : 0)
+            std::map<uint32_t, std::vector<std::unique_ptr<Block>>> pools;
+
+            uint64_t totalAllocations;
+            uint64_t totalFrees;
+
+            mutable std::mutex mutex;
+    };
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <vertex.hpp>
+
+namespace triangle {
+    // Indexed triangle list in the renderer's Vertex layout.
+    //
+    // Meshes are stored on disk in a small little-endian binary format:
+    //   char[4]  magic "TRIM"
+    //   uint32   version (1)
+    //   uint32   vertex count
+    //   uint32   index count (a multiple of 3)
+    //   Vertex   vertices[vertex count]   (vec2 position, vec3 color)
+    //   uint32   indices[index count]
+    struct Mesh {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        static Mesh load(const std::string& path);
+        void save(const std::string& path) const;
+
+        // 16-bit indices whenever every vertex can be addressed with them
+        VkIndexType getIndexType() const;
+        size_t getTriangleCount() const;
+
+        // Radius of the smallest origin-centred circle containing every vertex
+        float getBoundingRadius() const;
+    };
+
+    // Grid of columns x rows quads covering clip space, with a color gradient
+    Mesh generateGridMesh(uint32_t columns, uint32_t rows);
+
+    // Lays count instances out on a square grid covering [-extent, extent] in clip space,
+    // each scaled to its cell. Extents above 1 place part of the grid off screen.
+    std::vector<InstanceData> generateInstanceGrid(uint32_t count, float extent = 1.0f);
+
+    // Reorders triangles for post-transform vertex cache locality using Tom Forsyth's
+    // linear-speed algorithm. The vertex buffer itself is left untouched.
+    void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 32);
+
+    // Average cache miss ratio (transformed vertices per triangle) of a simulated FIFO
+    // post-transform cache. 0.5 is the ideal for large regular meshes, 3.0 the worst case.
+    double computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 32);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+
+namespace triangle {
+    // VkPipelineCache backed by a file. Data from disk is only handed to the driver when
+    // its header matches this device, so a cache from another GPU or driver starts cold.
+    class PipelineCache {
+        public:
+            // An empty path keeps the cache in memory only
+            PipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path);
+            ~PipelineCache();
+
+            // Per-user cache file under $XDG_CACHE_HOME, or ~/.cache without it. Empty when
+            // neither is set, which keeps the cache in memory.
+            static std::string defaultPath();
+
+            PipelineCache(const PipelineCache&) = delete;
+            PipelineCache& operator=(const PipelineCache&) = delete;
+
+            VkPipelineCache get() const;
+
+            // True when valid data for this device was loaded from disk
+            bool isWarm() const;
+            size_t getLoadedSize() const;
+
+            // Writes to a temporary file and renames it over the old one, so a crash mid-save
+            // never leaves a truncated cache behind
+            void save();
+
+        private:
+            bool validateHeader(const std::vector<char>& data) const;
+
+            VkDevice device;
+            VkPhysicalDeviceProperties deviceProperties;
+            std::string path;
+
+            VkPipelineCache cache;
+            bool warm;
+            size_t loadedSize;
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <functional>
+
+#include <thread_pool.hpp>
+
+namespace triangle {
+    // Compiles pipelines on background worker threads. Callers get a handle immediately and
+    // poll it each frame, drawing with whatever is already ready instead of blocking.
+    //
+    // Every job shares one VkPipelineCache. Pipeline caches are internally synchronized unless
+    // created with VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT, so no extra locking
+    // is needed around it.
+    class PipelineManager {
+        public:
+            // 0 is never a valid handle
+            using Handle = uint64_t;
+            using BuildFunction = std::function<VkPipeline(VkPipelineCache cache)>;
+
+            struct Stats {
+                uint64_t submitted = 0;
+                uint64_t compiled = 0;
+                uint64_t failed = 0;
+                // Summed time spent inside build functions across all workers
+                double compileMs = 0.0;
+            };
+
+            // With no threads, pipelines are built synchronously inside submit()
+            PipelineManager(VkDevice device, VkPipelineCache cache, size_t threadCount);
+            ~PipelineManager();
+
+            PipelineManager(const PipelineManager&) = delete;
+            PipelineManager& operator=(const PipelineManager&) = delete;
+
+            Handle submit(BuildFunction build);
+
+            // The pipeline if it has finished compiling, otherwise VK_NULL_HANDLE. A failed
+            // build rethrows its exception here.
+            VkPipeline tryGet(Handle handle) const;
+            VkPipeline wait(Handle handle) const;
+
+            // Whether the build has finished, successfully or not, so destroy() will not block
+            bool isReady(Handle handle) const;
+
+            // Waits for the build if needed and destroys the pipeline
+            void destroy(Handle handle);
+            void waitIdle() const;
+
+            Stats getStats() const;
+
+        private:
+            std::shared_future<VkPipeline> find(Handle handle) const;
+
+            VkDevice device;
+            VkPipelineCache cache;
+
+            Handle nextHandle;
+            std::map<Handle, std::shared_future<VkPipeline>> pipelines;
+            Stats stats;
+            mutable std::mutex mutex;
+
+            // Declared last so workers are joined before anything they touch is destroyed
+            std::unique_ptr<ThreadPool> workers;
+    };
+}
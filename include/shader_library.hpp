@@ -0,0 +1,90 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace triangle {
+    // Entry in the table generated by embed_shaders() in CMakeLists.txt
+    struct EmbeddedShader {
+        const char* name;
+        const uint32_t* code;
+        size_t size;
+    };
+
+    // SPIR-V code for one shader. The words are either memory-mapped from a .spv file,
+    // compiled into the executable, or (where mapping is unavailable) read into memory;
+    // in every case the code is 4-byte aligned and can be handed to Vulkan as is.
+    class ShaderBlob {
+        public:
+            ShaderBlob() = default;
+            ~ShaderBlob();
+
+            ShaderBlob(ShaderBlob&& other) noexcept;
+            ShaderBlob& operator=(ShaderBlob&& other) noexcept;
+
+            ShaderBlob(const ShaderBlob&) = delete;
+            ShaderBlob& operator=(const ShaderBlob&) = delete;
+
+            static ShaderBlob mapFile(const std::string& path);
+            static ShaderBlob fromStatic(const uint32_t* code, size_t size);
+
+            const uint32_t* code() const;
+            // Size in bytes, as VkShaderModuleCreateInfo::codeSize expects
+            size_t size() const;
+
+        private:
+            void release();
+
+            const uint32_t* words = nullptr;
+            size_t bytes = 0;
+
+            // Set when words point into a mapping this blob owns
+            void* mapping = nullptr;
+            size_t mappingSize = 0;
+            // Used instead of a mapping on platforms without mmap
+            std::vector<uint32_t> storage;
+    };
+
+    // Finds shaders by name ("triangle.vert") either in the executable or in a directory
+    // of compiled .spv files. Safe to call from pipeline compile workers.
+    class ShaderLibrary {
+        public:
+            enum class Source {
+                Mapped,
+                Embedded
+            };
+
+            struct Stats {
+                uint32_t shadersLoaded = 0;
+                size_t bytesLoaded = 0;
+                // Summed time spent locating and mapping shaders
+                double loadMs = 0.0;
+            };
+
+            // An empty directory searches next to the executable, then the build tree.
+            // Ignored when shaders are embedded.
+            explicit ShaderLibrary(const std::string& directory = "");
+
+            ShaderBlob load(const std::string& name);
+
+            // Compiles <sourceDirectory>/<name> with glslc into this library's directory,
+            // replacing the old .spv atomically so concurrent loads never see a partial file
+            void compile(const std::string& sourceDirectory, const std::string& name);
+
+            Source getSource() const;
+            const std::string& getDirectory() const;
+            Stats getStats() const;
+
+        private:
+            static std::string findShaderDirectory();
+
+            std::string directory;
+
+            mutable std::mutex mutex;
+            Stats stats;
+    };
+}
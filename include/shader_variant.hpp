@@ -0,0 +1,45 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <vector>
+
+namespace triangle {
+    // Specialization constant values baked into a pipeline when it is compiled, so the driver
+    // can fold them and drop dead branches. Values are 32-bit words keyed by constant_id,
+    // which covers bool, int, uint and float constants. Equal variants hash equally, so a
+    // variant can key a cache of compiled pipelines.
+    class ShaderVariant {
+        public:
+            struct Hasher {
+                size_t operator()(const ShaderVariant& variant) const {
+                    return variant.hash();
+                }
+            };
+
+            ShaderVariant& set(uint32_t constantId, uint32_t value);
+            ShaderVariant& set(uint32_t constantId, int32_t value);
+            ShaderVariant& set(uint32_t constantId, float value);
+            ShaderVariant& set(uint32_t constantId, bool value);
+
+            // The returned info points into this variant, so it must stay alive and unchanged
+            // until the pipeline has been created. Constants a shader does not declare are
+            // ignored, so one variant can be shared by every stage of a pipeline.
+            VkSpecializationInfo getSpecializationInfo() const;
+
+            size_t hash() const;
+            bool operator==(const ShaderVariant& other) const;
+            bool operator!=(const ShaderVariant& other) const;
+
+        private:
+            void rebuild();
+
+            std::map<uint32_t, uint32_t> values;
+
+            // Laid out for VkSpecializationInfo, rebuilt whenever a value changes
+            std::vector<VkSpecializationMapEntry> entries;
+            std::vector<uint32_t> data;
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <frame_stats.hpp>
+
+namespace triangle {
+    // Watches a directory for modified shaders using inotify. Files are reported by shader
+    // name ("triangle.frag"), whether the change was to the GLSL source or to its .spv.
+    //
+    // Editors and compilers often write a file in several steps, so a shader is only
+    // reported once it has been quiet for the settle time. On platforms without inotify
+    // the watcher never reports anything.
+    class ShaderWatcher {
+        public:
+            ShaderWatcher(const std::string& directory, double settleMs = 100.0);
+            ~ShaderWatcher();
+
+            ShaderWatcher(const ShaderWatcher&) = delete;
+            ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+            // Non-blocking; returns the shaders that changed and have since settled
+            std::set<std::string> poll();
+
+            bool isActive() const;
+            const std::string& getDirectory() const;
+
+        private:
+            void readEvents();
+
+            std::string directory;
+            double settleMs;
+
+            int fd;
+            int watch;
+
+            std::vector<char> eventBuffer;
+            std::map<std::string, FrameClock::time_point> pending;
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <deque>
+#include <vector>
+
+namespace triangle {
+    // Persistently mapped, host-visible ring buffer used to stream data into device-local
+    // buffers. Copies are batched into command buffers submitted on a transfer-capable
+    // queue, each signalling the next value of the ring's timeline semaphore, and each region
+    // of the ring is reused only after its batch's value is reached.
+    //
+    // When the ring's queue belongs to another family than the queue using the buffers (a
+    // dedicated transfer queue), flush() releases ownership of the destination buffers and
+    // acquire() records the matching acquire on the consuming queue.
+    //
+    // Uploads still batched when the ring is destroyed are submitted and waited for, so their
+    // destination buffers must outlive it unless the owner flushes first.
+    class StagingRing {
+        public:
+            struct Stats {
+                uint64_t bytesUploaded = 0;
+                uint64_t batchesSubmitted = 0;
+                // Number of times an allocation had to block on an in-flight batch
+                uint64_t stalls = 0;
+            };
+
+            StagingRing(
+                VkDevice device,
+                VkQueue queue,
+                uint32_t queueFamilyIndex,
+                uint32_t dstQueueFamilyIndex,
+                VkBuffer buffer,
+                void* mappedData,
+                VkDeviceSize capacity
+            );
+            ~StagingRing();
+
+            StagingRing(const StagingRing&) = delete;
+            StagingRing& operator=(const StagingRing&) = delete;
+
+            // Copies data into the ring and records a transfer into dstBuffer. Uploads larger
+            // than the ring are split across several batches. Buffers created with
+            // VK_SHARING_MODE_CONCURRENT are shared between the families and never change owner.
+            void uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, bool concurrent = false);
+
+            // Submits the pending batch. Its copies are made visible to every later command
+            // on the same queue, or to the consuming queue once acquired.
+            void flush();
+
+            // Records the acquiring half of the ownership transfers flushed since the last call
+            // into a command buffer of the destination family. Returns the timeline value that
+            // submissions using the uploads must wait on, or 0 if nothing was flushed since.
+            uint64_t acquire(VkCommandBuffer commandBuffer);
+
+            // Drops the ownership transfers still queued for dstBuffer, so nothing is recorded
+            // against it once it is destroyed. Its copies must already have been flushed.
+            void forget(VkBuffer dstBuffer);
+
+            // Retires batches that have completed without blocking
+            void reclaim();
+            void waitIdle();
+
+            VkSemaphore getSemaphore() const;
+
+            const Stats& getStats() const;
+
+        private:
+            struct Batch {
+                uint64_t value;
+                VkCommandBuffer commandBuffer;
+                VkDeviceSize bytes;
+            };
+
+            VkDeviceSize allocate(VkDeviceSize size, VkDeviceSize alignment);
+            VkCommandBuffer currentCommandBuffer();
+            void retireOldest();
+
+            VkDevice device;
+            VkQueue queue;
+            VkCommandPool commandPool;
+            uint32_t queueFamilyIndex;
+            uint32_t dstQueueFamilyIndex;
+
+            VkSemaphore semaphore;
+            uint64_t submittedValue;
+            // Highest submitted value already waited for by a consuming submission
+            uint64_t acquiredValue;
+
+            VkBuffer buffer;
+            char* mappedData;
+            VkDeviceSize capacity;
+
+            // Next write position and bytes not yet free (including padding skipped on wrap)
+            VkDeviceSize head;
+            VkDeviceSize inUse;
+
+            std::deque<Batch> inFlight;
+            Batch pending;
+
+            // Destination ranges of exclusive buffers written by the pending batch, and those
+            // released by flushed batches but not yet acquired
+            std::vector<VkBufferMemoryBarrier> pendingTransfers;
+            std::vector<VkBufferMemoryBarrier> unacquiredTransfers;
+
+            std::vector<VkCommandBuffer> freeCommandBuffers;
+
+            Stats stats;
+    };
+}
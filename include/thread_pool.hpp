@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace triangle {
+    // Fixed-size pool of worker threads consuming a FIFO of tasks
+    class ThreadPool {
+        public:
+            explicit ThreadPool(size_t threadCount);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            size_t size() const;
+
+            // Queues a task; exceptions it throws are rethrown from the returned future
+            template<typename Task>
+            auto submit(Task&& task) -> std::future<decltype(task())> {
+                using Result = decltype(task());
+
+                auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+                std::future<Result> result = packaged->get_future();
+
+                {
+                    std::lock_guard<std::mutex> lock(this->queueMutex);
+                    this->tasks.emplace_back([packaged](){ (*packaged)(); });
+                }
+                this->queueCondition.notify_one();
+
+                return result;
+            }
+
+        private:
+            void workerLoop();
+
+            std::vector<std::thread> workers;
+            std::deque<std::function<void()>> tasks;
+
+            std::mutex queueMutex;
+            std::condition_variable queueCondition;
+            bool stopping;
+    };
+}
@@ -6,23 +6,171 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+
+#include <frame_stats.hpp>
+#include <thread_pool.hpp>
+#include <staging_ring.hpp>
+#include <memory_allocator.hpp>
+#include <vertex.hpp>
+#include <mesh.hpp>
+#include <pipeline_cache.hpp>
+#include <pipeline_manager.hpp>
+#include <shader_library.hpp>
+#include <shader_watcher.hpp>
+#include <shader_variant.hpp>
+#include <uniform_ring.hpp>
+#include <descriptor_allocator.hpp>
+#include <frame_scheduler.hpp>
+#include <frame_limiter.hpp>
 
 namespace triangle {
+    // Fragment shader output, baked into each pipeline as a specialization constant
+    enum class ColorMode : uint32_t {
+        Vertex = 0,
+        Luminance = 1,
+        Flat = 2
+    };
+
+    // How finished frames are queued for presentation, trading latency against frame rate
+    enum class PacingProfile : uint32_t {
+        // Fewest swapchain images, and with VK_KHR_present_wait each frame starts only once
+        // the previous one is on screen, so input is sampled as late as possible
+        LowLatency = 0,
+        // Vsynced FIFO with a spare image to absorb hitches
+        Smooth = 1,
+        // Uncapped frame rate with MAILBOX, falling back to vsynced FIFO rather than tearing
+        Throughput = 2
+    };
+
+    struct ApplicationSettings {
+        std::string title = "Triangle Application";
+        int width = 800;
+        int height = 600;
+        int framesInFlight = 2;
+
+        // Render into offscreen images without a window, surface or swapchain
+        bool headless = false;
+        // Stop after this many frames (0 runs until the window is closed)
+        uint64_t frameLimit = 0;
+
+        // Print instance extensions and device selection details to stdout
+        bool verbose = true;
+
+        // Chooses the present mode and swapchain image count (unused when headless)
+        PacingProfile pacingProfile = PacingProfile::Throughput;
+
+        // Cap the frame rate, sleeping between frames instead of spinning (0 leaves it uncapped)
+        double targetFrameRate = 0.0;
+        // Also hold frames to the GPU's measured frame time and, when windowed, the display
+        // refresh rate, so the CPU sleeps before polling input rather than racing ahead and
+        // blocking on the GPU or rendering frames the display discards
+        bool adaptiveFrameSleep = false;
+
+        // Record draws into secondary command buffers on this many worker threads
+        // (0 records everything inline into the primary command buffer)
+        uint32_t recordingThreads = 0;
+
+        // Log averaged GPU render pass time every N frames when verbose (0 disables)
+        uint32_t gpuTimingLogInterval = 1000;
+
+        // Size of the persistently mapped ring used to upload into device-local buffers
+        VkDeviceSize stagingBufferSize = 8 * 1024 * 1024;
+
+        // Binary mesh to draw instead of the built-in triangle (see mesh.hpp)
+        std::string meshPath;
+        // Reorder the loaded mesh's triangles for vertex cache locality
+        bool optimizeMesh = true;
+
+        // Cull every instance against the view in a compute pass and draw the survivors
+        // with indirect draws, ignoring the draw list
+        bool gpuCulling = false;
+
+        // Run culling on a compute-only queue family and uploads on a transfer-only one when
+        // the device has them, so they overlap rendering instead of queueing behind it
+        bool asyncQueues = true;
+
+        // Begin rendering directly on the target image views with VK_KHR_dynamic_rendering when
+        // the device supports it, instead of through a render pass and per-image framebuffers
+        bool dynamicRendering = true;
+
+        // File the pipeline cache is loaded from and saved to, per user by default so runs do
+        // not write into whatever directory they were started from (empty keeps it in memory)
+        std::string pipelineCachePath = PipelineCache::defaultPath();
+        // Background threads compiling pipelines (0 compiles them synchronously)
+        uint32_t pipelineCompileThreads = 2;
+
+        // Directory of compiled .spv shaders; empty searches next to the executable, then the
+        // build tree. Unused when shaders are embedded with TRIANGLE_EMBED_SHADERS.
+        std::string shaderDirectory;
+
+        // Rebuild pipelines in the background when their shaders change, drawing with the
+        // old ones until the new ones are ready. Watches the compiled .spv files, or the GLSL
+        // in shaderSourceDirectory (recompiled with glslc) when that is set.
+        bool hotReload = false;
+        std::string shaderSourceDirectory;
+
+        ColorMode colorMode = ColorMode::Vertex;
+
+        // Bytes of uniform data each frame in flight can write to the uniform ring
+        VkDeviceSize uniformRingFrameSize = 64 * 1024;
+    };
+
+    struct StartupTimings {
+        // Wall time of Vulkan initialization and until the first frame that actually drew
+        double initMs = 0.0;
+        double firstDrawMs = 0.0;
+        // Time spent compiling pipelines before the first draw, summed across worker threads
+        double pipelineMs = 0.0;
+        // Time spent locating and mapping SPIR-V before the first draw
+        double shaderLoadMs = 0.0;
+        // Whether shaders came from the executable rather than .spv files
+        bool shadersEmbedded = false;
+        // Whether the pipeline cache started with valid data from a previous run
+        bool pipelineCacheWarm = false;
+    };
+
+    // Objects created for the render targets so far, and the time spent rebuilding them when
+    // the window or offscreen targets were resized
+    struct RenderTargetStats {
+        uint64_t renderPasses = 0;
+        uint64_t framebuffers = 0;
+        uint64_t imageViews = 0;
+        uint64_t recreations = 0;
+        double lastRecreateMs = 0.0;
+        double totalRecreateMs = 0.0;
+    };
+
+    // One indexed draw, recorded into the frame's command buffer as-is
+    struct DrawCommand {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t firstInstance;
+
+        // Pushed as a constant before the draw: xy offset, z scale (w unused)
+        glm::vec4 transform = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    };
+
+    // Per-frame vertex shader data, written to the uniform ring every frame (std140 layout)
+    struct FrameUniforms {
+        // 2x2 view matrix (zoom and rotation) in column order, then the view offset in xy
+        glm::vec4 viewMatrix;
+        glm::vec4 viewOffset;
+        // Seconds since initialization in x, the frame number in y
+        glm::vec4 time;
+    };
+
     class TriangleApplication {
         public:
-            struct Vertex{
-                glm::vec2 pos;
-                glm::vec3 color;
+            // Invoked once per frame before recording, e.g. to update the draw list
+            using FrameCallback = std::function<void(TriangleApplication& app, uint64_t frameIndex)>;
 
-                static VkVertexInputBindingDescription getBindingDescription();
-                static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions();
-            };
-
-            const std::vector<Vertex> vertices = {
-                {{0.0f, -0.5f}, {1.0f, 1.0f, 1.0f}},
-                {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
-                {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
-            };
+            using Vertex = triangle::Vertex;
 
         private:
             int maxFramesInFlight;
@@ -30,15 +178,25 @@ namespace triangle {
             int initialWindowWidth;
             int initialWindowHeight;
 
+            bool headless;
+            uint64_t frameLimit;
+            uint64_t frameCount;
+
+            bool verbose;
+            std::string deviceName;
+            FrameTimings lastFrameTimings;
+
             GLFWwindow* window;
             VkInstance vkInstance;
             VkDevice device;
             VkPhysicalDevice physicalDevice;
 
+            // Frame pacing and GPU progress; retired objects are keyed by its timeline values
+            std::unique_ptr<FrameScheduler> frameScheduler;
+            // Binary semaphores for the swapchain, which cannot use timeline semaphores: one
+            // acquire semaphore per frame slot and one present semaphore per swapchain image
             std::vector<VkSemaphore> imageAvailableSemaphores;
             std::vector<VkSemaphore> renderFinishedSemaphores;
-            std::vector<VkFence> inFlightFences;
-            std::vector<VkFence> imagesInFlight;
             size_t currentFrame;
 
             bool framebufferResized = false;
@@ -49,6 +207,34 @@ namespace triangle {
             VkQueue graphicsQueue;
             VkQueue presentQueue;
 
+            // Dedicated queues, or the graphics queue when the device has no such family
+            bool asyncQueues;
+            uint32_t graphicsQueueFamily;
+            VkQueue computeQueue;
+            uint32_t computeQueueFamily;
+            VkQueue transferQueue;
+            uint32_t transferQueueFamily;
+
+            // Frame pacing. Presents are identified by their frame's timeline value.
+            PacingProfile pacingProfile;
+            VkPresentModeKHR presentMode;
+            bool presentWaitEnabled;
+            PFN_vkWaitForPresentKHR waitForPresent;
+            uint64_t lastPresentId;
+            FrameClock::time_point lastPresentStart;
+            // Start of the frame last submitted from each slot, for latency estimates
+            std::vector<FrameClock::time_point> frameStartTimes;
+
+            // Sleeps before each frame; the interval is refreshed every frame in adaptive mode
+            FrameLimiter frameLimiter;
+            double targetFrameRate;
+            bool adaptiveFrameSleep;
+            // Refresh interval of the display showing the window, or 0 when headless or unknown
+            double refreshIntervalMs;
+            // Smoothed GPU render pass time, 0 until the first timestamps arrive
+            double gpuFrameEstimateMs;
+            double limiterWaitMs;
+
             VkSwapchainKHR swapChain;
             std::vector<VkImage> swapChainImages;
             VkFormat swapChainImageFormat;
@@ -56,17 +242,165 @@ namespace triangle {
 
             std::vector<VkImageView> swapChainImageViews;
 
+            // Objects replaced by recreateSwapChain(), destroyed once no frame can still use them
+            struct RetiredSwapChain {
+                uint64_t releaseValue;
+                VkSwapchainKHR swapChain;
+                std::vector<VkImageView> imageViews;
+                std::vector<VkFramebuffer> framebuffers;
+                std::vector<VkSemaphore> renderFinishedSemaphores;
+                // Set when the format changed and these were replaced too (the render pass is
+                // null under dynamic rendering)
+                VkRenderPass renderPass;
+                VkPipelineLayout pipelineLayout;
+                // Headless render targets, which stand in for the swapchain
+                std::vector<VkImage> offscreenImages;
+                std::vector<Allocation> offscreenImageAllocations;
+            };
+            std::deque<RetiredSwapChain> retiredSwapChains;
+
+            VkExtent2D offscreenExtent;
+            std::vector<Allocation> offscreenImageAllocations;
+
+            // Without a render pass or framebuffers, rendering begins on the image views and
+            // layout transitions are explicit barriers
+            bool dynamicRenderingEnabled;
+            PFN_vkCmdBeginRenderingKHR cmdBeginRendering;
+            PFN_vkCmdEndRenderingKHR cmdEndRendering;
+            RenderTargetStats renderTargetStats;
+
+            std::string pipelineCachePath;
+            std::unique_ptr<PipelineCache> pipelineCache;
+            uint32_t pipelineCompileThreads;
+            std::string shaderDirectory;
+            std::unique_ptr<ShaderLibrary> shaderLibrary;
+
+            // Shader hot reload; pending handles are rebuilds not yet swapped in (0 if none)
+            bool hotReload;
+            std::string shaderSourceDirectory;
+            std::unique_ptr<ShaderWatcher> shaderWatcher;
+            PipelineManager::Handle pendingGraphicsPipeline;
+            ShaderVariant pendingGraphicsVariant;
+            PipelineManager::Handle pendingCullPipeline;
+
+            // Pipelines replaced by a reload, destroyed once no frame in flight can use them
+            struct RetiredPipeline {
+                uint64_t releaseValue;
+                PipelineManager::Handle pipeline;
+            };
+            std::deque<RetiredPipeline> retiredPipelines;
+            std::unique_ptr<PipelineManager> pipelineManager;
+            StartupTimings startupTimings;
+            FrameClock::time_point initStart;
+            bool firstDrawRecorded;
+
             VkRenderPass renderPass;
             VkPipelineLayout pipelineLayout;
-            VkPipeline graphicsPipeline;
+            // Every specialization of the graphics pipeline built so far, keyed by its constants.
+            // graphicsPipeline is the one being drawn with, which lags graphicsVariant while a
+            // newly requested variant compiles.
+            ColorMode colorMode;
+            ShaderVariant graphicsVariant;
+            std::unordered_map<ShaderVariant, PipelineManager::Handle, ShaderVariant::Hasher> graphicsVariants;
+            uint64_t graphicsVariantsBuilt;
+            PipelineManager::Handle graphicsPipeline;
+            // Pipelines resolved for the frame being recorded (VK_NULL_HANDLE while compiling)
+            VkPipeline activeGraphicsPipeline;
+            VkPipeline activeCullPipeline;
 
             std::vector<VkFramebuffer> swapChainFramebuffers;
 
             VkCommandPool commandPool;
-            std::vector<VkCommandBuffer> commandBuffers;
+            std::vector<VkCommandPool> frameCommandPools;
+            std::vector<VkCommandBuffer> frameCommandBuffers;
+
+            // Indexed [frame in flight][recording thread]
+            uint32_t recordingThreads;
+            std::unique_ptr<ThreadPool> recordingPool;
+            std::vector<std::vector<VkCommandPool>> secondaryCommandPools;
+            std::vector<std::vector<VkCommandBuffer>> secondaryCommandBuffers;
+
+            std::vector<DrawCommand> drawList;
+            FrameCallback frameCallback;
+
+            // Two timestamps (render pass begin/end) per frame in flight
+            VkQueryPool timestampQueryPool;
+            bool gpuTimestampsSupported;
+            float timestampPeriod;
+            uint64_t timestampMask;
+            std::vector<bool> timestampQueriesPending;
+
+            double lastGpuRenderPassMs;
+            uint32_t gpuTimingLogInterval;
+            uint32_t gpuTimingSampleCount;
+            double gpuTimingSum;
+            double gpuTimingMin;
+            double gpuTimingMax;
+
+            // Every buffer and image is sub-allocated from here
+            std::unique_ptr<MemoryAllocator> memoryAllocator;
+
+            Mesh mesh;
 
             VkBuffer vertexBuffer;
-            VkDeviceMemory vertexBufferMemory;
+            Allocation vertexBufferAllocation;
+
+            std::vector<InstanceData> instances;
+            VkBuffer instanceBuffer;
+            Allocation instanceBufferAllocation;
+
+            VkBuffer indexBuffer;
+            Allocation indexBufferAllocation;
+            VkIndexType indexType;
+
+            // Compute culling writes a draw count and one indirect command per instance into
+            // a buffer per frame in flight
+            bool gpuCulling;
+            bool drawIndirectCountSupported;
+            bool multiDrawIndirectSupported;
+            uint32_t maxDrawIndirectCount;
+            PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount;
+
+            // Owned by the layout cache; the set itself comes from the descriptor allocator
+            VkDescriptorSetLayout cullDescriptorSetLayout;
+            VkPipelineLayout cullPipelineLayout;
+            PipelineManager::Handle cullPipeline;
+            std::vector<VkBuffer> drawBuffers;
+            std::vector<Allocation> drawBufferAllocations;
+
+            // Culling on the compute queue: each frame's dispatch signals the frame's value on
+            // computeSemaphore and hands the draw buffer over to the graphics family
+            bool asyncCompute;
+            std::vector<VkCommandPool> computeCommandPools;
+            std::vector<VkCommandBuffer> computeCommandBuffers;
+            VkSemaphore computeSemaphore;
+            bool computeSubmitPending;
+            // Staging timeline value the frame's submissions wait on (0 if none)
+            uint64_t stagingWaitValue;
+
+            std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache;
+            std::unique_ptr<DescriptorAllocator> descriptorAllocator;
+
+            // Per-frame uniforms, bound through one dynamic uniform buffer descriptor
+            VkDeviceSize uniformRingFrameSize;
+            VkBuffer uniformBuffer;
+            Allocation uniformBufferAllocation;
+            std::unique_ptr<UniformRing> uniformRing;
+            VkDescriptorSetLayout frameDescriptorSetLayout;
+            VkDescriptorPool frameDescriptorPool;
+            VkDescriptorSet frameDescriptorSet;
+            // Uniforms and dynamic offset of the frame being recorded
+            FrameUniforms frameUniforms;
+            uint32_t frameUniformOffset;
+
+            glm::vec2 viewOffset;
+            float viewZoom;
+            float viewRotation;
+
+            VkDeviceSize stagingBufferSize;
+            VkBuffer stagingBuffer;
+            Allocation stagingBufferAllocation;
+            std::unique_ptr<StagingRing> stagingRing;
 
             bool validationLayersEnabled;
             std::vector<const char*> validationLayers;
@@ -80,18 +414,86 @@ namespace triangle {
                 int initialHeight = 600,
                 int framesInFlight = 2
             );
+            TriangleApplication(const ApplicationSettings& settings);
 
             void run();
+            void benchmark(uint32_t warmupFrames, uint32_t measuredFrames, FrameStats& stats);
+
+            const FrameTimings& getLastFrameTimings() const;
+            const std::string& getDeviceName() const;
+
+            void setDrawList(std::vector<DrawCommand> drawList);
+            const std::vector<DrawCommand>& getDrawList() const;
+            void setFrameCallback(FrameCallback callback);
+
+            // Most recent GPU time between render pass begin and end, or negative if none yet
+            double getLastGpuRenderPassMs() const;
+
+            MemoryAllocator::Stats getMemoryStats() const;
+            const Mesh& getMesh() const;
+            const StartupTimings& getStartupTimings() const;
+
+            // Present mode and image count picked for the pacing profile, and whether frames are
+            // paced with VK_KHR_present_wait
+            VkPresentModeKHR getPresentMode() const;
+            uint32_t getSwapChainImageCount() const;
+            bool hasPresentWait() const;
+
+            // Interval the frame limiter is currently holding frames to (0 when uncapped)
+            double getFrameInterval() const;
+            FrameLimiter::Stats getFrameLimiterStats() const;
+
+            // Whether frames render without render pass and framebuffer objects
+            bool hasDynamicRendering() const;
+            RenderTargetStats getRenderTargetStats() const;
+
+            // Rebuilds the render targets at the end of the current frame: offscreen targets at
+            // this size, or the swapchain after resizing the window. Call once rendering has
+            // started, e.g. from a frame callback.
+            void resize(uint32_t width, uint32_t height);
+
+            // Whether instances are culled on the GPU; false when requested but unsupported
+            bool hasGpuCulling() const;
+
+            // Whether culling and uploads run on their own queue families
+            bool hasAsyncCompute() const;
+            bool hasAsyncTransfer() const;
+
+            // Descriptor sets allocated here are valid until this frame slot comes around
+            // again; only use from a frame callback or while recording
+            DescriptorAllocator& getDescriptorAllocator();
+            DescriptorLayoutCache& getDescriptorLayoutCache();
+
+            // Replaces the per-instance data read by draws through firstInstance/instanceCount.
+            // Once rendering has started this waits for the device, so it is not meant for
+            // per-frame updates.
+            void setInstances(std::vector<InstanceData> instances);
+
+            // Pans, zooms and rotates the whole scene through the per-frame uniforms
+            void setView(glm::vec2 offset, float zoom, float rotation);
+
+            // Takes effect once the matching pipeline variant has compiled
+            void setColorMode(ColorMode mode);
+            ColorMode getColorMode() const;
+            // Graphics pipeline variants compiled so far, including ones since replaced
+            uint64_t getPipelineVariantCount() const;
+            const std::vector<InstanceData>& getInstances() const;
 
         private:
             void initVulkan();
             void initWindow();
             void mainLoop();
+            void benchmarkLoop(uint32_t warmupFrames, uint32_t measuredFrames, FrameStats& stats);
             void cleanUp();
 
             void drawFrame();
+            // Waits until the next frame is due under the frame rate cap or adaptive pacing
+            void paceFrame();
+            // Takes the refresh rate of the monitor the window overlaps most
+            void updateRefreshInterval();
 
             static void framebufferResizedCallback(GLFWwindow* window, int width, int height);
+            static void windowMovedCallback(GLFWwindow* window, int x, int y);
 
             void createVkInstance();
             bool checkValidationLayerSupport();
@@ -101,11 +503,15 @@ namespace triangle {
 
             void pickPhysicalDevice();
             bool checkDeviceExtensionSupport(const VkPhysicalDevice device);
+            bool checkOptionalDeviceExtension(const VkPhysicalDevice device, const char* extensionName);
             unsigned int rateDeviceSuitability(const VkPhysicalDevice device);
 
             struct QueueFamilyIndicies {
                 std::optional<uint32_t> graphicsFamily;
                 std::optional<uint32_t> presentFamily;
+                // Families without graphics support, which run alongside the graphics queue
+                std::optional<uint32_t> computeFamily;
+                std::optional<uint32_t> transferFamily;
 
                 bool isComplete();
             };
@@ -113,9 +519,12 @@ namespace triangle {
 
             void createLogicalDevice();
 
-            void createSwapChain();
+            void createSwapChain(VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE);
+            void createOffscreenImages();
             void recreateSwapChain();
             void cleanUpSwapChain();
+            void cleanUpGraphicsPipeline();
+            void releaseRetiredSwapChains(uint64_t completedValue);
             struct SwapChainSupportDetails{
                 VkSurfaceCapabilitiesKHR capabilities;
                 std::vector<VkSurfaceFormatKHR> formats;
@@ -130,24 +539,71 @@ namespace triangle {
 
             void createRenderPass();
 
-            std::vector<char> readFile(const std::string& filename);
-            VkShaderModule createShaderModule(const std::vector<char>& code);
+            VkShaderModule createShaderModule(const ShaderBlob& code);
             void createGraphicsPipeline();
+            PipelineManager::Handle submitGraphicsPipeline(const ShaderVariant& variant, const std::vector<std::string>& recompile);
+            VkPipeline buildGraphicsPipeline(VkPipelineCache cache, VkRenderPass renderPass, VkFormat colorFormat, VkPipelineLayout layout, const ShaderVariant& variant);
+            ShaderVariant selectGraphicsVariant() const;
+            PipelineManager::Handle getGraphicsVariant(const ShaderVariant& variant);
+            void retireGraphicsVariants();
 
             void createFrameBuffers();
 
             void createCommandPool();
             void createCommandBuffers();
+            void recordCommandBuffer(size_t frameIndex, uint32_t imageIndex);
+            void recordSecondaryCommandBuffer(size_t frameIndex, size_t threadIndex, uint32_t imageIndex, size_t firstDraw, size_t drawCount);
+            // Clears and begins rendering to the image through the render pass or dynamic rendering
+            void beginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondaryCommandBuffers);
+            void endRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+            void recordDraws(VkCommandBuffer commandBuffer, size_t firstDraw, size_t drawCount);
+            void setViewportAndScissor(VkCommandBuffer commandBuffer);
+            void recordCulling(VkCommandBuffer commandBuffer, size_t frameIndex);
+            void recordAsyncCulling(VkCommandBuffer commandBuffer, size_t frameIndex);
+            void submitCompute(size_t frameIndex);
+            void recordIndirectDraws(VkCommandBuffer commandBuffer, size_t frameIndex);
+
+            void createQueryPool();
+            bool collectGpuTimings(size_t frameIndex);
+            void waitForPreviousPresent();
 
             void createSyncObjects();
+            void createRenderFinishedSemaphores();
 
             void setupDebugMessenger();
             void populateDebugMessengerCreateInfo(
                 VkDebugUtilsMessengerCreateInfoEXT& createInfo
             );
 
+            void createBuffer(
+                VkDeviceSize size,
+                VkBufferUsageFlags usage,
+                VkMemoryPropertyFlags properties,
+                VkBuffer& buffer,
+                Allocation& allocation,
+                bool shared = false
+            );
+            void createStagingRing();
+            void createFrameUniforms();
+            void destroyFrameUniforms();
+            void updateFrameUniforms(size_t frameIndex);
+            void bindFrameResources(VkCommandBuffer commandBuffer);
             void createVertexBuffers();
-            uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+            void createIndexBuffer();
+            void createInstanceBuffer();
+
+            void createCullingPipeline();
+            PipelineManager::Handle submitCullingPipeline(const std::vector<std::string>& recompile);
+            VkPipeline buildCullingPipeline(VkPipelineCache cache, VkPipelineLayout layout);
+
+            void createShaderWatcher();
+            void reloadChangedShaders();
+            void resolvePipelines();
+            PipelineManager::Handle takeReloadedPipeline(PipelineManager::Handle& pending);
+            void retirePipeline(PipelineManager::Handle pipeline);
+            void releaseRetiredPipelines(uint64_t completedValue);
+            void createDrawBuffers();
+            void destroyDrawBuffers();
 
             VkResult createVkDebugMessenger(
                 const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
@@ -0,0 +1,58 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+namespace triangle {
+    // Persistently mapped uniform buffer split into one region per frame in flight. A frame
+    // writes its data at increasing offsets within its own region and binds it through a
+    // dynamic uniform buffer descriptor, so a single descriptor set serves every frame and
+    // nothing is allocated or updated per frame.
+    class UniformRing {
+        public:
+            struct Stats {
+                // Most bytes (including alignment padding) any single frame has used
+                VkDeviceSize peakFrameBytes = 0;
+                VkDeviceSize frameCapacity = 0;
+            };
+
+            // The buffer must be host-coherent and at least frameCount * frameStride(...) bytes
+            UniformRing(
+                VkBuffer buffer,
+                void* mappedData,
+                VkDeviceSize alignment,
+                VkDeviceSize frameCapacity,
+                uint32_t frameCount
+            );
+
+            // Size of each frame's region once rounded up to the offset alignment
+            static VkDeviceSize frameStride(VkDeviceSize frameCapacity, VkDeviceSize alignment);
+
+            // Starts writing the region for a frame slot, whose previous submission must have
+            // completed
+            void beginFrame(uint32_t frameIndex);
+
+            // Copies data into the current frame's region and returns the dynamic offset to bind
+            uint32_t push(const void* data, VkDeviceSize size);
+
+            template<typename T>
+            uint32_t push(const T& value){
+                return this->push(&value, sizeof(T));
+            }
+
+            VkBuffer getBuffer() const;
+            Stats getStats() const;
+
+        private:
+            VkBuffer buffer;
+            char* mappedData;
+            VkDeviceSize alignment;
+            VkDeviceSize stride;
+            uint32_t frameCount;
+
+            VkDeviceSize frameStart;
+            VkDeviceSize head;
+
+            Stats stats;
+    };
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace triangle {
+    struct Vertex{
+        glm::vec2 pos;
+        glm::vec3 color;
+
+        static VkVertexInputBindingDescription getBindingDescription();
+        static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions();
+    };
+
+    // Per-instance attributes, streamed from binding 1 at VK_VERTEX_INPUT_RATE_INSTANCE
+    struct InstanceData{
+        // xy offset in clip space, z uniform scale, w rotation in radians
+        glm::vec4 transform;
+        // Multiplied with the vertex color; alpha is unused
+        glm::vec4 color;
+
+        static VkVertexInputBindingDescription getBindingDescription();
+        static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions();
+    };
+}
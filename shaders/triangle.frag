@@ -1,10 +1,23 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Specialization constants, see ShaderVariant and ColorMode.
+// 0 writes the vertex color, 1 its luminance, 2 flat white.
+layout(constant_id = 1) const uint COLOR_MODE = 0;
+
 layout(location = 0) out vec4 outColor;
 
 layout(location = 0) in vec3 fragColor;
 
 void main(){
-    outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    vec3 color = fragColor;
+
+    if (COLOR_MODE == 1){
+        color = vec3(dot(fragColor, vec3(0.2126, 0.7152, 0.0722)));
+    }
+    else if (COLOR_MODE == 2){
+        color = vec3(1.0);
+    }
+
+    outColor = vec4(color, 1.0);
+}
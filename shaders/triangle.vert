@@ -1,12 +1,44 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Specialization constants, see ShaderVariant. Skips the rotation when no instance is rotated.
+layout(constant_id = 0) const bool INSTANCE_ROTATION = true;
+
+// Per-frame data from the uniform ring, bound with a dynamic offset (see FrameUniforms)
+layout(std140, set = 0, binding = 0) uniform FrameUniforms {
+    // 2x2 view matrix in column order, then the view offset in xy
+    vec4 viewMatrix;
+    vec4 viewOffset;
+    // Seconds since initialization, frame number
+    vec4 time;
+} frame;
+
+// Per-draw transform: xy offset, z scale
+layout(push_constant) uniform DrawConstants {
+    vec4 transform;
+} draw;
+
 layout(location=0) in vec2 inPosition;
 layout(location=1) in vec3 inColor;
 
+// Per-instance: xy offset, z scale, w rotation, and a color multiplier
+layout(location=2) in vec4 inInstanceTransform;
+layout(location=3) in vec4 inInstanceColor;
+
 layout(location = 0) out vec3 fragColor;
 
 void main(){
-    gl_Position = vec4(inPosition, 0.0, 1.0);
-    fragColor = inColor;
-}
\ No newline at end of file
+    vec2 position = inPosition * inInstanceTransform.z;
+
+    if (INSTANCE_ROTATION){
+        float s = sin(inInstanceTransform.w);
+        float c = cos(inInstanceTransform.w);
+        position = mat2(c, s, -s, c) * position;
+    }
+
+    position = (position + inInstanceTransform.xy) * draw.transform.z + draw.transform.xy;
+    position = mat2(frame.viewMatrix.xy, frame.viewMatrix.zw) * position + frame.viewOffset.xy;
+
+    gl_Position = vec4(position, 0.0, 1.0);
+    fragColor = inColor * inInstanceColor.rgb;
+}
@@ -0,0 +1,550 @@
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <random>
+#include <cstdio>
+#include <algorithm>
+#include <triangle.hpp>
+#include <arguments.hpp>
+
+using namespace triangle;
+
+struct BenchmarkOptions {
+    uint32_t warmupFrames = 100;
+    uint32_t measuredFrames = 1000;
+
+    // Upper bound on recording threads for --record-scaling (0 runs the frame benchmark)
+    uint32_t recordScalingThreads = 0;
+    uint32_t drawCount = 10000;
+
+    // Upper bound on instances for --instance-scaling (0 runs the frame benchmark)
+    uint32_t instanceScalingMax = 0;
+    // Half-width of the instance grid in clip space; above 1 some instances are off screen
+    float instanceExtent = 1.0f;
+
+    // Descriptor sets allocated per frame for --descriptor-sets (0 runs the frame benchmark)
+    uint32_t descriptorSetsPerFrame = 0;
+
+    // Resize the render targets every N frames and report the cost of rebuilding them
+    uint32_t resizeInterval = 0;
+
+    // Measure vertex cache efficiency of a mesh instead of rendering (no device needed)
+    bool vertexCache = false;
+    uint32_t gridSize = 512;
+    uint32_t cacheSize = 32;
+    std::string saveMeshPath;
+};
+
+// Quotes a string for JSON output, escaping driver names and paths that contain quotes,
+// backslashes or control characters
+std::string jsonString(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\r': quoted += "\\r"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    quoted += escaped;
+                }
+                else {
+                    quoted += c;
+                }
+        }
+    }
+    return quoted + "\"";
+}
+
+std::string pacingProfileName(PacingProfile profile) {
+    switch (profile) {
+        case PacingProfile::LowLatency: return "low-latency";
+        case PacingProfile::Smooth: return "smooth";
+        case PacingProfile::Throughput: return "throughput";
+    }
+    return "unknown";
+}
+
+std::string presentModeName(VkPresentModeKHR mode) {
+    switch (mode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo-relaxed";
+        default: return "unknown";
+    }
+}
+
+// Runs the renderer for a fixed number of frames and reports frame time percentiles
+void runFrameBenchmark(const ApplicationSettings& settings, const BenchmarkOptions& options, std::ostream& out) {
+    TriangleApplication app(settings);
+    FrameStats stats;
+
+    auto start = FrameClock::now();
+    app.benchmark(options.warmupFrames, options.measuredFrames, stats);
+    double totalSeconds = elapsedMilliseconds(start) / 1000.0;
+
+    MemoryAllocator::Stats memory = app.getMemoryStats();
+
+    std::map<std::string, std::string> fields = {
+        {"device", jsonString(app.getDeviceName())},
+        {"headless", settings.headless ? "true" : "false"},
+        {"warmup_frames", std::to_string(options.warmupFrames)},
+        {"frames_in_flight", std::to_string(settings.framesInFlight)},
+        {"recording_threads", std::to_string(settings.recordingThreads)},
+        {"gpu_culling", app.hasGpuCulling() ? "true" : "false"},
+        {"pacing_profile", jsonString(pacingProfileName(settings.pacingProfile))},
+        {"present_mode", settings.headless ? "null" : jsonString(presentModeName(app.getPresentMode()))},
+        {"present_wait", app.hasPresentWait() ? "true" : "false"},
+        {"swapchain_images", std::to_string(app.getSwapChainImageCount())},
+        {"target_frame_rate", std::to_string(settings.targetFrameRate)},
+        {"adaptive_frame_sleep", settings.adaptiveFrameSleep ? "true" : "false"},
+        {"frame_interval_ms", std::to_string(app.getFrameInterval())},
+        {"limiter_missed_deadlines", std::to_string(app.getFrameLimiterStats().missedDeadlines)},
+        {"async_compute", app.hasAsyncCompute() ? "true" : "false"},
+        {"async_transfer", app.hasAsyncTransfer() ? "true" : "false"},
+        {"dynamic_rendering", app.hasDynamicRendering() ? "true" : "false"},
+        {"render_passes_created", std::to_string(app.getRenderTargetStats().renderPasses)},
+        {"framebuffers_created", std::to_string(app.getRenderTargetStats().framebuffers)},
+        {"image_views_created", std::to_string(app.getRenderTargetStats().imageViews)},
+        {"startup_ms", std::to_string(app.getStartupTimings().initMs)},
+        {"first_draw_ms", std::to_string(app.getStartupTimings().firstDrawMs)},
+        {"pipeline_ms", std::to_string(app.getStartupTimings().pipelineMs)},
+        {"pipeline_threads", std::to_string(settings.pipelineCompileThreads)},
+        {"shader_load_ms", std::to_string(app.getStartupTimings().shaderLoadMs)},
+        {"pipeline_variants", std::to_string(app.getPipelineVariantCount())},
+        {"shaders_embedded", app.getStartupTimings().shadersEmbedded ? "true" : "false"},
+        {"pipeline_cache_warm", app.getStartupTimings().pipelineCacheWarm ? "true" : "false"},
+        {"triangles", std::to_string(app.getMesh().getTriangleCount())},
+        {"total_seconds", std::to_string(totalSeconds)},
+        {"memory_blocks", std::to_string(memory.blockCount)},
+        {"memory_allocations", std::to_string(memory.allocationCount)},
+        {"memory_bytes_allocated", std::to_string(memory.bytesAllocated)},
+        {"memory_bytes_used", std::to_string(memory.bytesUsed)},
+        {"memory_fragmentation", std::to_string(memory.fragmentation)}
+    };
+
+    stats.writeJson(out, fields);
+}
+
+// Records the same large draw list with 1..N threads and reports how recording time scales
+void runRecordScaling(const ApplicationSettings& settings, const BenchmarkOptions& options, std::ostream& out) {
+    std::vector<DrawCommand> drawList(options.drawCount, DrawCommand{3, 1, 0, 0, 0});
+
+    std::string deviceName;
+    std::stringstream results;
+
+    for (uint32_t threads = 1; threads <= options.recordScalingThreads; threads++) {
+        ApplicationSettings threadSettings = settings;
+        threadSettings.recordingThreads = threads;
+
+        TriangleApplication app(threadSettings);
+        app.setDrawList(drawList);
+
+        FrameStats stats;
+        app.benchmark(options.warmupFrames, options.measuredFrames, stats);
+        deviceName = app.getDeviceName();
+
+        FrameStats::Percentiles record = FrameStats::computePercentiles(stats.samples("record_ms"));
+
+        results << (threads > 1 ? "," : "") << std::endl <<
+            "    {\"threads\": " << threads <<
+            ", \"record_ms\": {\"p50\": " << record.p50 << ", \"p95\": " << record.p95 <<
+            ", \"p99\": " << record.p99 << ", \"max\": " << record.max << "}" <<
+            ", \"draws_per_ms\": " << (record.p50 > 0.0 ? options.drawCount / record.p50 : 0.0) << "}";
+    }
+
+    out << "{" << std::endl <<
+        "  \"device\": " << jsonString(deviceName) << "," << std::endl <<
+        "  \"mode\": \"record_scaling\"," << std::endl <<
+        "  \"draws\": " << options.drawCount << "," << std::endl <<
+        "  \"frames\": " << options.measuredFrames << "," << std::endl <<
+        "  \"results\": [" << results.str() << std::endl << "  ]" << std::endl <<
+        "}" << std::endl;
+}
+
+// Draws the mesh with 1, 4, 16, ... instances up to the maximum and reports triangle throughput
+void runInstanceScaling(const ApplicationSettings& settings, const BenchmarkOptions& options, std::ostream& out) {
+    std::string deviceName;
+    bool gpuCulling = false;
+    std::stringstream results;
+
+    for (uint32_t instances = 1; instances <= options.instanceScalingMax; instances *= 4) {
+        TriangleApplication app(settings);
+        app.setInstances(generateInstanceGrid(instances, options.instanceExtent));
+
+        uint32_t indexCount = static_cast<uint32_t>(app.getMesh().indices.size());
+        app.setDrawList({{indexCount, instances, 0, 0, 0}});
+
+        FrameStats stats;
+        app.benchmark(options.warmupFrames, options.measuredFrames, stats);
+        deviceName = app.getDeviceName();
+        gpuCulling = app.hasGpuCulling();
+
+        double trianglesPerFrame = static_cast<double>(app.getMesh().getTriangleCount()) * instances;
+        FrameStats::Percentiles frame = FrameStats::computePercentiles(stats.samples("cpu_frame_ms"));
+        FrameStats::Percentiles record = FrameStats::computePercentiles(stats.samples("record_ms"));
+
+        // GPU timings are absent when the device has no timestamp support
+        FrameStats::Percentiles gpu = {};
+        if (stats.hasSamples("gpu_render_pass_ms")) {
+            gpu = FrameStats::computePercentiles(stats.samples("gpu_render_pass_ms"));
+        }
+
+        results << (instances > 1 ? "," : "") << std::endl <<
+            "    {\"instances\": " << instances <<
+            ", \"triangles_per_frame\": " << trianglesPerFrame <<
+            ", \"cpu_frame_ms_p50\": " << frame.p50 <<
+            ", \"record_ms_p50\": " << record.p50 <<
+            ", \"gpu_render_pass_ms_p50\": " << gpu.p50 <<
+            ", \"triangles_per_sec\": " << (frame.p50 > 0.0 ? trianglesPerFrame * 1000.0 / frame.p50 : 0.0) <<
+            ", \"gpu_triangles_per_sec\": " << (gpu.p50 > 0.0 ? trianglesPerFrame * 1000.0 / gpu.p50 : 0.0) << "}";
+
+        // Guard against overflow when the maximum is close to UINT32_MAX
+        if (instances > options.instanceScalingMax / 4) {
+            break;
+        }
+    }
+
+    out << "{" << std::endl <<
+        "  \"device\": " << jsonString(deviceName) << "," << std::endl <<
+        "  \"mode\": \"instance_scaling\"," << std::endl <<
+        "  \"gpu_culling\": " << (gpuCulling ? "true" : "false") << "," << std::endl <<
+        "  \"instance_extent\": " << options.instanceExtent << "," << std::endl <<
+        "  \"frames\": " << options.measuredFrames << "," << std::endl <<
+        "  \"results\": [" << results.str() << std::endl << "  ]" << std::endl <<
+        "}" << std::endl;
+}
+
+// Allocates many short-lived descriptor sets every frame and reports allocation throughput
+void runDescriptorBenchmark(const ApplicationSettings& settings, const BenchmarkOptions& options, std::ostream& out) {
+    TriangleApplication app(settings);
+    FrameStats allocStats;
+
+    app.setFrameCallback([&options, &allocStats](TriangleApplication& app, uint64_t frameIndex) {
+        VkDescriptorSetLayoutBinding storage = {};
+        storage.binding = 0;
+        storage.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        storage.descriptorCount = 1;
+        storage.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        VkDescriptorSetLayoutBinding uniform = storage;
+        uniform.binding = 1;
+        uniform.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+        // Looked up every frame to include the layout cache hit in the measurement
+        auto start = FrameClock::now();
+        VkDescriptorSetLayout layout = app.getDescriptorLayoutCache().get({storage, uniform});
+        for (uint32_t i = 0; i < options.descriptorSetsPerFrame; i++) {
+            app.getDescriptorAllocator().allocate(layout);
+        }
+        double allocMs = elapsedMilliseconds(start);
+
+        if (frameIndex >= options.warmupFrames) {
+            allocStats.record("descriptor_alloc_ms", allocMs);
+        }
+    });
+
+    FrameStats stats;
+    app.benchmark(options.warmupFrames, options.measuredFrames, stats);
+
+    DescriptorAllocator::Stats descriptors = app.getDescriptorAllocator().getStats();
+    FrameStats::Percentiles alloc = FrameStats::computePercentiles(allocStats.samples("descriptor_alloc_ms"));
+
+    std::map<std::string, std::string> fields = {
+        {"device", jsonString(app.getDeviceName())},
+        {"mode", "\"descriptor_allocation\""},
+        {"frames_in_flight", std::to_string(settings.framesInFlight)},
+        {"sets_per_frame", std::to_string(options.descriptorSetsPerFrame)},
+        {"sets_per_ms", std::to_string(alloc.p50 > 0.0 ? options.descriptorSetsPerFrame / alloc.p50 : 0.0)},
+        {"sets_allocated", std::to_string(descriptors.setsAllocated)},
+        {"pools_created", std::to_string(descriptors.poolsCreated)},
+        {"pool_resets", std::to_string(descriptors.poolResets)}
+    };
+
+    allocStats.writeJson(out, fields);
+}
+
+// Resizes the render targets every few frames, alternating between the configured size and half
+// of it, and reports how long rebuilding them takes and how many objects that created
+void runResizeBenchmark(const ApplicationSettings& settings, const BenchmarkOptions& options, std::ostream& out) {
+    TriangleApplication app(settings);
+    uint32_t interval = options.resizeInterval;
+
+    app.setFrameCallback([&settings, interval](TriangleApplication& app, uint64_t frameIndex) {
+        if ((frameIndex + 1) % interval != 0) {
+            return;
+        }
+
+        bool shrink = ((frameIndex + 1) / interval) % 2 == 1;
+        int width = shrink ? std::max(1, settings.width / 2) : settings.width;
+        int height = shrink ? std::max(1, settings.height / 2) : settings.height;
+        app.resize(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    });
+
+    FrameStats stats;
+    app.benchmark(options.warmupFrames, options.measuredFrames, stats);
+
+    RenderTargetStats targets = app.getRenderTargetStats();
+
+    std::map<std::string, std::string> fields = {
+        {"device", jsonString(app.getDeviceName())},
+        {"mode", "\"resize\""},
+        {"headless", settings.headless ? "true" : "false"},
+        {"dynamic_rendering", app.hasDynamicRendering() ? "true" : "false"},
+        {"resize_interval", std::to_string(interval)},
+        {"recreations", std::to_string(targets.recreations)},
+        {"recreate_ms_avg", std::to_string(targets.recreations > 0 ? targets.totalRecreateMs / targets.recreations : 0.0)},
+        {"render_passes_created", std::to_string(targets.renderPasses)},
+        {"framebuffers_created", std::to_string(targets.framebuffers)},
+        {"image_views_created", std::to_string(targets.imageViews)}
+    };
+
+    stats.writeJson(out, fields);
+}
+
+// Compares simulated post-transform cache miss ratios before and after optimizeVertexCache
+void runVertexCacheBenchmark(const ApplicationSettings& settings, const BenchmarkOptions& options, std::ostream& out) {
+    Mesh mesh;
+    bool shuffled = false;
+
+    if (!settings.meshPath.empty()) {
+        mesh = Mesh::load(settings.meshPath);
+    }
+    else {
+        // A generated grid is already emitted in scanline order, so shuffle its triangles to
+        // stand in for an unoptimized export
+        mesh = generateGridMesh(options.gridSize, options.gridSize);
+
+        std::vector<uint32_t> order(mesh.getTriangleCount());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+
+        std::vector<uint32_t> indices;
+        indices.reserve(mesh.indices.size());
+        for (uint32_t triangleIndex : order) {
+            indices.insert(indices.end(), mesh.indices.begin() + triangleIndex * 3, mesh.indices.begin() + triangleIndex * 3 + 3);
+        }
+        mesh.indices.swap(indices);
+        shuffled = true;
+    }
+
+    double acmrBefore = computeAcmr(mesh.indices, mesh.vertices.size(), options.cacheSize);
+
+    auto start = FrameClock::now();
+    optimizeVertexCache(mesh.indices, mesh.vertices.size(), options.cacheSize);
+    double optimizeMs = elapsedMilliseconds(start);
+
+    double acmrAfter = computeAcmr(mesh.indices, mesh.vertices.size(), options.cacheSize);
+
+    if (!options.saveMeshPath.empty()) {
+        mesh.save(options.saveMeshPath);
+    }
+
+    out << "{" << std::endl <<
+        "  \"mode\": \"vertex_cache\"," << std::endl <<
+        "  \"source\": " << jsonString(settings.meshPath.empty() ? "grid" : settings.meshPath) << "," << std::endl <<
+        "  \"shuffled\": " << (shuffled ? "true" : "false") << "," << std::endl <<
+        "  \"vertices\": " << mesh.vertices.size() << "," << std::endl <<
+        "  \"triangles\": " << mesh.getTriangleCount() << "," << std::endl <<
+        "  \"index_type\": " << (mesh.getIndexType() == VK_INDEX_TYPE_UINT16 ? 16 : 32) << "," << std::endl <<
+        "  \"cache_size\": " << options.cacheSize << "," << std::endl <<
+        "  \"acmr_before\": " << acmrBefore << "," << std::endl <<
+        "  \"acmr_after\": " << acmrAfter << "," << std::endl <<
+        "  \"optimize_ms\": " << optimizeMs << std::endl <<
+        "}" << std::endl;
+}
+
+// Headless by default so it can run against a software ICD on machines without a display.
+int main(int argc, char** argv) {
+    ApplicationSettings settings;
+    settings.title = "Triangle Benchmark";
+    settings.headless = true;
+    settings.verbose = false;
+
+    BenchmarkOptions options;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--windowed") {
+            settings.headless = false;
+        }
+        else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmupFrames = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--frames" && i + 1 < argc) {
+            options.measuredFrames = parseArgument<uint32_t>(arg, argv[++i]);
+            // Every mode reports percentiles of the measured frames
+            if (options.measuredFrames == 0) {
+                std::cerr << "--frames must be at least 1" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--frames-in-flight" && i + 1 < argc) {
+            settings.framesInFlight = parseArgument<int>(arg, argv[++i]);
+        }
+        else if (arg == "--recording-threads" && i + 1 < argc) {
+            settings.recordingThreads = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--record-scaling" && i + 1 < argc) {
+            options.recordScalingThreads = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--draws" && i + 1 < argc) {
+            options.drawCount = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--instance-scaling" && i + 1 < argc) {
+            options.instanceScalingMax = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--instance-extent" && i + 1 < argc) {
+            options.instanceExtent = parseArgument<float>(arg, argv[++i]);
+        }
+        else if (arg == "--gpu-culling") {
+            settings.gpuCulling = true;
+        }
+        else if (arg == "--no-async-queues") {
+            settings.asyncQueues = false;
+        }
+        else if (arg == "--no-dynamic-rendering") {
+            settings.dynamicRendering = false;
+        }
+        else if (arg == "--pipeline-cache" && i + 1 < argc) {
+            settings.pipelineCachePath = argv[++i];
+        }
+        else if (arg == "--pipeline-threads" && i + 1 < argc) {
+            settings.pipelineCompileThreads = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--shader-dir" && i + 1 < argc) {
+            settings.shaderDirectory = argv[++i];
+        }
+        else if (arg == "--pacing" && i + 1 < argc) {
+            std::string profile = argv[++i];
+            if (profile == "low-latency") {
+                settings.pacingProfile = triangle::PacingProfile::LowLatency;
+            }
+            else if (profile == "smooth") {
+                settings.pacingProfile = triangle::PacingProfile::Smooth;
+            }
+            else if (profile == "throughput") {
+                settings.pacingProfile = triangle::PacingProfile::Throughput;
+            }
+            else {
+                std::cerr << "Unknown pacing profile: " << profile << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--fps-limit" && i + 1 < argc) {
+            settings.targetFrameRate = parseArgument<double>(arg, argv[++i]);
+        }
+        else if (arg == "--adaptive-sleep") {
+            settings.adaptiveFrameSleep = true;
+        }
+        else if (arg == "--color-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "vertex") {
+                settings.colorMode = triangle::ColorMode::Vertex;
+            }
+            else if (mode == "luminance") {
+                settings.colorMode = triangle::ColorMode::Luminance;
+            }
+            else if (mode == "flat") {
+                settings.colorMode = triangle::ColorMode::Flat;
+            }
+            else {
+                std::cerr << "Unknown color mode: " << mode << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--mesh" && i + 1 < argc) {
+            settings.meshPath = argv[++i];
+        }
+        else if (arg == "--no-mesh-optimize") {
+            settings.optimizeMesh = false;
+        }
+        else if (arg == "--descriptor-sets" && i + 1 < argc) {
+            options.descriptorSetsPerFrame = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--resize-interval" && i + 1 < argc) {
+            options.resizeInterval = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--vertex-cache") {
+            options.vertexCache = true;
+        }
+        else if (arg == "--grid" && i + 1 < argc) {
+            options.gridSize = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--cache-size" && i + 1 < argc) {
+            options.cacheSize = parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--save-mesh" && i + 1 < argc) {
+            options.saveMeshPath = argv[++i];
+        }
+        else if (arg == "--width" && i + 1 < argc) {
+            settings.width = parseArgument<int>(arg, argv[++i]);
+        }
+        else if (arg == "--height" && i + 1 < argc) {
+            settings.height = parseArgument<int>(arg, argv[++i]);
+        }
+        else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] <<
+                " [--windowed] [--warmup N] [--frames M] [--frames-in-flight N] [--recording-threads N]" <<
+                " [--record-scaling MAX_THREADS [--draws D]]" <<
+                " [--instance-scaling MAX_INSTANCES [--instance-extent E]] [--gpu-culling] [--no-async-queues] [--no-dynamic-rendering]" <<
+                " [--descriptor-sets SETS_PER_FRAME] [--resize-interval FRAMES]" <<
+                " [--pipeline-cache FILE] [--pipeline-threads N] [--shader-dir DIR]" <<
+                " [--color-mode vertex|luminance|flat] [--pacing low-latency|smooth|throughput]" <<
+                " [--fps-limit FPS] [--adaptive-sleep]" <<
+                " [--mesh FILE] [--no-mesh-optimize]" <<
+                " [--vertex-cache [--grid N] [--cache-size N] [--save-mesh FILE]]" <<
+                " [--width W] [--height H] [--output FILE]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        std::ofstream outputFile;
+        if (!outputPath.empty()) {
+            outputFile.open(outputPath);
+            if (!outputFile.is_open()) {
+                throw std::runtime_error("Failed to open benchmark output: " + outputPath);
+            }
+        }
+        std::ostream& out = outputPath.empty() ? std::cout : outputFile;
+
+        if (options.vertexCache) {
+            runVertexCacheBenchmark(settings, options, out);
+        }
+        else if (options.instanceScalingMax > 0) {
+            runInstanceScaling(settings, options, out);
+        }
+        else if (options.descriptorSetsPerFrame > 0) {
+            runDescriptorBenchmark(settings, options, out);
+        }
+        else if (options.resizeInterval > 0) {
+            runResizeBenchmark(settings, options, out);
+        }
+        else if (options.recordScalingThreads > 0) {
+            runRecordScaling(settings, options, out);
+        }
+        else {
+            runFrameBenchmark(settings, options, out);
+        }
+    }
+    catch (std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
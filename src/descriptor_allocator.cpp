@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <stdexcept>
+#include <descriptor_allocator.hpp>
+
+using namespace triangle;
+
+namespace {
+    // Pools stop growing here; beyond it more pools are simply added
+    const uint32_t maxSetsPerPool = 4096;
+}
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device) {
+    this->device = device;
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache() {
+    for (auto& entry : this->layouts){
+        vkDestroyDescriptorSetLayout(this->device, entry.second, nullptr);
+    }
+}
+
+VkDescriptorSetLayout DescriptorLayoutCache::get(std::vector<VkDescriptorSetLayoutBinding> bindings) {
+    std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b){
+        return a.binding < b.binding;
+    });
+
+    Key key = {std::move(bindings)};
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto it = this->layouts.find(key);
+    if (it != this->layouts.end()){
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(key.bindings.size());
+    layoutInfo.pBindings = key.bindings.data();
+
+    VkDescriptorSetLayout layout;
+    if (vkCreateDescriptorSetLayout(this->device, &layoutInfo, nullptr, &layout) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create descriptor set layout");
+    }
+
+    // Track how many descriptors of each type a single set may need
+    for (const VkDescriptorSetLayoutBinding& binding : key.bindings){
+        uint32_t count = 0;
+        for (const VkDescriptorSetLayoutBinding& other : key.bindings){
+            if (other.descriptorType == binding.descriptorType) count += other.descriptorCount;
+        }
+
+        auto it = std::find_if(this->descriptorsPerSet.begin(), this->descriptorsPerSet.end(), [&](const VkDescriptorPoolSize& size){
+            return size.type == binding.descriptorType;
+        });
+        if (it == this->descriptorsPerSet.end()){
+            this->descriptorsPerSet.push_back({binding.descriptorType, count});
+        }
+        else {
+            it->descriptorCount = std::max(it->descriptorCount, count);
+        }
+    }
+
+    this->layouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+size_t DescriptorLayoutCache::size() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->layouts.size();
+}
+
+std::vector<VkDescriptorPoolSize> DescriptorLayoutCache::getDescriptorsPerSet() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->descriptorsPerSet;
+}
+
+bool DescriptorLayoutCache::Key::operator==(const Key& other) const {
+    if (this->bindings.size() != other.bindings.size()){
+        return false;
+    }
+
+    for (size_t i = 0; i < this->bindings.size(); i++){
+        const VkDescriptorSetLayoutBinding& a = this->bindings[i];
+        const VkDescriptorSetLayoutBinding& b = other.bindings[i];
+
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+            a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags ||
+            a.pImmutableSamplers != b.pImmutableSamplers){
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t DescriptorLayoutCache::KeyHasher::operator()(const Key& key) const {
+    // FNV-1a over the fields that make two layouts different
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value){
+        for (int i = 0; i < 8; i++){
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (const VkDescriptorSetLayoutBinding& binding : key.bindings){
+        mix(binding.binding);
+        mix(static_cast<uint64_t>(binding.descriptorType));
+        mix(binding.descriptorCount);
+        mix(binding.stageFlags);
+        mix(reinterpret_cast<uintptr_t>(binding.pImmutableSamplers));
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+DescriptorAllocator::DescriptorAllocator(
+    VkDevice device,
+    const DescriptorLayoutCache& layoutCache,
+    uint32_t frameCount,
+    uint32_t initialSetsPerPool
+) : layoutCache(layoutCache) {
+    if (frameCount == 0){
+        throw std::invalid_argument("The descriptor allocator needs at least one frame");
+    }
+    if (initialSetsPerPool == 0){
+        throw std::invalid_argument("Descriptor pools must hold at least one set");
+    }
+
+    this->device = device;
+    this->setsPerPool = initialSetsPerPool;
+    this->poolGeneration = 0;
+    this->framePools.resize(frameCount);
+    this->currentFrame = 0;
+}
+
+DescriptorAllocator::~DescriptorAllocator() {
+    for (auto& pools : this->framePools){
+        for (const Pool& pool : pools){
+            vkDestroyDescriptorPool(this->device, pool.handle, nullptr);
+        }
+    }
+    for (const Pool& pool : this->freePools){
+        vkDestroyDescriptorPool(this->device, pool.handle, nullptr);
+    }
+}
+
+void DescriptorAllocator::beginFrame(uint32_t frameIndex) {
+    if (frameIndex >= this->framePools.size()){
+        throw std::out_of_range("Descriptor allocator frame index out of range");
+    }
+
+    this->currentFrame = frameIndex;
+
+    // Resetting a pool frees all of its sets at once. Pools sized for an older set of
+    // layouts may lack descriptor types in use now, so they are dropped instead.
+    for (const Pool& pool : this->framePools[frameIndex]){
+        if (pool.generation != this->poolGeneration){
+            vkDestroyDescriptorPool(this->device, pool.handle, nullptr);
+            continue;
+        }
+
+        vkResetDescriptorPool(this->device, pool.handle, 0);
+        this->freePools.push_back(pool);
+        this->stats.poolResets++;
+    }
+    this->framePools[frameIndex].clear();
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+    std::vector<Pool>& pools = this->framePools[this->currentFrame];
+    if (pools.empty()){
+        pools.push_back(this->acquirePool());
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pools.back().handle;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet set;
+    VkResult result = vkAllocateDescriptorSets(this->device, &allocInfo, &set);
+
+    // A full pool is left as it is until the frame comes around again
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL){
+        pools.push_back(this->acquirePool());
+        allocInfo.descriptorPool = pools.back().handle;
+        result = vkAllocateDescriptorSets(this->device, &allocInfo, &set);
+    }
+
+    // A fresh pool fits any cached layout, so this one did not come from the cache
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY){
+        throw std::runtime_error("Failed to allocate descriptor set: its layout is not in the layout cache");
+    }
+    if (result != VK_SUCCESS){
+        throw std::runtime_error("Failed to allocate descriptor set");
+    }
+
+    this->stats.setsAllocated++;
+    return set;
+}
+
+DescriptorAllocator::Stats DescriptorAllocator::getStats() const {
+    return this->stats;
+}
+
+DescriptorAllocator::Pool DescriptorAllocator::acquirePool() {
+    // A layout added since the free pools were created may need types or counts they lack
+    std::vector<VkDescriptorPoolSize> descriptorsPerSet = this->layoutCache.getDescriptorsPerSet();
+    bool changed = descriptorsPerSet.size() != this->descriptorsPerSet.size() ||
+        !std::equal(descriptorsPerSet.begin(), descriptorsPerSet.end(), this->descriptorsPerSet.begin(), [](const VkDescriptorPoolSize& a, const VkDescriptorPoolSize& b){
+            return a.type == b.type && a.descriptorCount == b.descriptorCount;
+        });
+
+    if (changed){
+        for (const Pool& pool : this->freePools){
+            vkDestroyDescriptorPool(this->device, pool.handle, nullptr);
+        }
+        this->freePools.clear();
+
+        this->descriptorsPerSet = std::move(descriptorsPerSet);
+        this->poolGeneration++;
+    }
+
+    if (!this->freePools.empty()){
+        Pool pool = this->freePools.back();
+        this->freePools.pop_back();
+        return pool;
+    }
+
+    if (this->descriptorsPerSet.empty()){
+        throw std::runtime_error("Cannot create a descriptor pool before any layout with bindings is cached");
+    }
+
+    std::vector<VkDescriptorPoolSize> poolSizes = this->descriptorsPerSet;
+    for (VkDescriptorPoolSize& poolSize : poolSizes){
+        poolSize.descriptorCount *= this->setsPerPool;
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = this->setsPerPool;
+
+    Pool pool = {VK_NULL_HANDLE, this->poolGeneration};
+    if (vkCreateDescriptorPool(this->device, &poolInfo, nullptr, &pool.handle) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create descriptor pool");
+    }
+
+    // Frames that need many sets quickly reach larger pools
+    this->setsPerPool = std::min(this->setsPerPool * 2, std::max(this->setsPerPool, maxSetsPerPool));
+    this->stats.poolsCreated++;
+
+    return pool;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <thread>
+#include <frame_limiter.hpp>
+
+using namespace triangle;
+
+namespace {
+    // Bounds on the spin tail: some spin always covers scheduler jitter, and a timer that is
+    // consistently very late is not worth spinning a whole frame for
+    constexpr double minSpinMarginMs = 0.1;
+    constexpr double maxSpinMarginMs = 4.0;
+    // How quickly the margin shrinks back after a late wakeup, per frame
+    constexpr double spinMarginDecay = 0.99;
+
+    FrameClock::duration toDuration(double milliseconds){
+        return std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::milli>(milliseconds));
+    }
+}
+
+FrameLimiter::FrameLimiter() {
+    this->intervalMs = 0.0;
+    this->started = false;
+    this->spinMarginMs = 1.0;
+}
+
+void FrameLimiter::setInterval(double intervalMs) {
+    this->intervalMs = std::max(0.0, intervalMs);
+}
+
+double FrameLimiter::getInterval() const {
+    return this->intervalMs;
+}
+
+double FrameLimiter::wait() {
+    auto start = FrameClock::now();
+
+    if (this->intervalMs <= 0.0){
+        this->started = false;
+        return 0.0;
+    }
+
+    this->stats.frames++;
+    auto interval = toDuration(this->intervalMs);
+
+    if (!this->started || start > this->deadline + interval){
+        if (this->started){
+            this->stats.missedDeadlines++;
+        }
+        this->deadline = start;
+        this->started = true;
+    }
+
+    // Sleep until the spin margin before the deadline, then learn from how late the wakeup was
+    auto sleepUntil = this->deadline - toDuration(this->spinMarginMs);
+    if (start < sleepUntil){
+        std::this_thread::sleep_until(sleepUntil);
+
+        auto woke = FrameClock::now();
+        this->stats.sleepMs += elapsedMilliseconds(start, woke);
+
+        double oversleepMs = woke > sleepUntil ? elapsedMilliseconds(sleepUntil, woke) : 0.0;
+        this->spinMarginMs = std::clamp(std::max(oversleepMs * 1.5, this->spinMarginMs * spinMarginDecay),
+            minSpinMarginMs, maxSpinMarginMs);
+    }
+
+    auto spinStart = FrameClock::now();
+    while (FrameClock::now() < this->deadline){
+        std::this_thread::yield();
+    }
+    this->stats.spinMs += elapsedMilliseconds(spinStart);
+
+    // Keep the cadence even when this frame started a little late
+    this->deadline += interval;
+
+    return elapsedMilliseconds(start);
+}
+
+double FrameLimiter::getSpinMargin() const {
+    return this->spinMarginMs;
+}
+
+FrameLimiter::Stats FrameLimiter::getStats() const {
+    return this->stats;
+}
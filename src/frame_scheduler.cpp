@@ -0,0 +1,102 @@
+#include <stdexcept>
+#include <frame_stats.hpp>
+#include <frame_scheduler.hpp>
+
+using namespace triangle;
+
+FrameScheduler::FrameScheduler(VkDevice device, uint32_t framesInFlight) {
+    if (framesInFlight == 0){
+        throw std::invalid_argument("The frame scheduler needs at least one frame in flight");
+    }
+
+    this->device = device;
+    this->framesInFlight = framesInFlight;
+    this->submittedValue = 0;
+    this->completedValue = 0;
+
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semInfo = {};
+    semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(this->device, &semInfo, nullptr, &this->semaphore) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create the frame timeline semaphore");
+    }
+}
+
+FrameScheduler::~FrameScheduler() {
+    vkDestroySemaphore(this->device, this->semaphore, nullptr);
+}
+
+uint32_t FrameScheduler::beginFrame() {
+    uint64_t frameValue = this->getFrameValue();
+
+    // The slot was last used framesInFlight frames ago
+    if (frameValue > this->framesInFlight){
+        uint64_t slotValue = frameValue - this->framesInFlight;
+
+        if (this->getCompletedValue() < slotValue){
+            auto waitStart = FrameClock::now();
+            this->wait(slotValue);
+            this->stats.waitMs += elapsedMilliseconds(waitStart);
+            this->stats.stalls++;
+        }
+    }
+
+    return static_cast<uint32_t>((frameValue - 1) % this->framesInFlight);
+}
+
+uint64_t FrameScheduler::getFrameValue() const {
+    return this->submittedValue + 1;
+}
+
+void FrameScheduler::endFrame() {
+    this->submittedValue++;
+}
+
+uint64_t FrameScheduler::getSubmittedValue() const {
+    return this->submittedValue;
+}
+
+uint64_t FrameScheduler::getCompletedValue() {
+    if (this->completedValue < this->submittedValue){
+        if (vkGetSemaphoreCounterValue(this->device, this->semaphore, &this->completedValue) != VK_SUCCESS){
+            throw std::runtime_error("Failed to read the frame timeline semaphore");
+        }
+    }
+
+    return this->completedValue;
+}
+
+void FrameScheduler::wait(uint64_t value) {
+    if (value > this->submittedValue){
+        throw std::logic_error("Waiting on a frame that has not been submitted");
+    }
+    if (value <= this->completedValue){
+        return;
+    }
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &this->semaphore;
+    waitInfo.pValues = &value;
+
+    if (vkWaitSemaphores(this->device, &waitInfo, UINT64_MAX) != VK_SUCCESS){
+        throw std::runtime_error("Failed to wait for the frame timeline semaphore");
+    }
+
+    this->completedValue = value;
+}
+
+VkSemaphore FrameScheduler::getSemaphore() const {
+    return this->semaphore;
+}
+
+FrameScheduler::Stats FrameScheduler::getStats() const {
+    return this->stats;
+}
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <frame_stats.hpp>
+
+using namespace triangle;
+
+void FrameStats::record(const FrameTimings& timings){
+    this->record("cpu_frame_ms", timings.cpuFrameMs);
+    this->record("acquire_wait_ms", timings.acquireWaitMs);
+    this->record("fence_wait_ms", timings.fenceWaitMs);
+    this->record("present_ms", timings.presentMs);
+    this->record("present_wait_ms", timings.presentWaitMs);
+    this->record("record_ms", timings.recordMs);
+    this->record("limiter_wait_ms", timings.limiterWaitMs);
+
+    // Time the CPU spent doing work rather than blocked on the GPU or the presentation engine
+    this->record("cpu_work_ms", std::max(0.0, timings.cpuFrameMs - timings.acquireWaitMs - timings.fenceWaitMs - timings.presentWaitMs));
+
+    if (timings.gpuRenderPassMs >= 0.0){
+        this->record("gpu_render_pass_ms", timings.gpuRenderPassMs);
+    }
+    if (timings.latencyMs >= 0.0){
+        this->record("latency_ms", timings.latencyMs);
+    }
+    if (timings.recreateMs >= 0.0){
+        this->record("recreate_ms", timings.recreateMs);
+    }
+
+    this->frames++;
+}
+
+void FrameStats::record(const std::string& series, double value){
+    this->series[series].push_back(value);
+}
+
+void FrameStats::clear(){
+    this->series.clear();
+    this->frames = 0;
+}
+
+size_t FrameStats::frameCount() const {
+    return this->frames;
+}
+
+const std::vector<double>& FrameStats::samples(const std::string& series) const {
+    auto it = this->series.find(series);
+    if (it == this->series.end()){
+        throw std::runtime_error("Unknown frame statistics series: " + series);
+    }
+
+    return it->second;
+}
+
+bool FrameStats::hasSamples(const std::string& series) const {
+    return this->series.find(series) != this->series.end();
+}
+
+FrameStats::Percentiles FrameStats::computePercentiles(std::vector<double> values){
+    Percentiles result = {};
+    if (values.empty()){
+        return result;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    // Nearest-rank percentile
+    auto rank = [&values](double percentile){
+        size_t index = static_cast<size_t>(std::ceil(percentile / 100.0 * values.size()));
+        return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+    };
+
+    result.p50 = rank(50.0);
+    result.p95 = rank(95.0);
+    result.p99 = rank(99.0);
+    result.max = values.back();
+
+    return result;
+}
+
+double FrameStats::cpuGpuOverlap() const {
+    auto gpu = this->series.find("gpu_render_pass_ms");
+    auto work = this->series.find("cpu_work_ms");
+    auto wall = this->series.find("cpu_frame_ms");
+    if (gpu == this->series.end() || work == this->series.end() || wall == this->series.end() || gpu->second.empty()){
+        return -1.0;
+    }
+
+    auto sum = [](const std::vector<double>& values){
+        double total = 0.0;
+        for (double value : values) total += value;
+        return total;
+    };
+
+    // GPU samples lag behind and may be missing for some frames, so compare per-frame averages
+    double gpuMs = sum(gpu->second) / gpu->second.size();
+    double workMs = sum(work->second) / work->second.size();
+    double wallMs = sum(wall->second) / wall->second.size();
+
+    double shorter = std::min(gpuMs, workMs);
+    if (shorter <= 0.0){
+        return -1.0;
+    }
+
+    // Serialized execution takes cpu + gpu per frame; anything less was overlapped
+    double overlapMs = workMs + gpuMs - wallMs;
+    return std::min(1.0, std::max(0.0, overlapMs / shorter));
+}
+
+void FrameStats::writeJson(std::ostream& out, const std::map<std::string, std::string>& fields) const {
+    out << "{" << std::endl;
+    out << "  \"frames\": " << this->frames;
+    out << "," << std::endl << "  \"cpu_gpu_overlap\": " << this->cpuGpuOverlap();
+
+    // Extra fields are written verbatim, so string values must already be quoted
+    for (const auto& field : fields){
+        out << "," << std::endl << "  \"" << field.first << "\": " << field.second;
+    }
+
+    for (const auto& entry : this->series){
+        Percentiles percentiles = computePercentiles(entry.second);
+
+        out << "," << std::endl << "  \"" << entry.first << "\": {" <<
+            "\"p50\": " << percentiles.p50 << ", " <<
+            "\"p95\": " << percentiles.p95 << ", " <<
+            "\"p99\": " << percentiles.p99 << ", " <<
+            "\"max\": " << percentiles.max << "}";
+    }
+
+    out << std::endl << "}" << std::endl;
+}
@@ -6,13 +6,127 @@
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <string>
 #include <iostream>
 #include <triangle.hpp>
+#include <arguments.hpp>
 
 int main(int argc, char** argv) {
-    triangle::TriangleApplication app;
+    triangle::ApplicationSettings settings;
+    uint32_t instanceCount = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--headless") {
+            settings.headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc) {
+            settings.frameLimit = triangle::parseArgument<uint64_t>(arg, argv[++i]);
+        }
+        else if (arg == "--frames-in-flight" && i + 1 < argc) {
+            settings.framesInFlight = triangle::parseArgument<int>(arg, argv[++i]);
+        }
+        else if (arg == "--recording-threads" && i + 1 < argc) {
+            settings.recordingThreads = triangle::parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--instances" && i + 1 < argc) {
+            instanceCount = triangle::parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--gpu-culling") {
+            settings.gpuCulling = true;
+        }
+        else if (arg == "--no-async-queues") {
+            settings.asyncQueues = false;
+        }
+        else if (arg == "--no-dynamic-rendering") {
+            settings.dynamicRendering = false;
+        }
+        else if (arg == "--pipeline-cache" && i + 1 < argc) {
+            settings.pipelineCachePath = argv[++i];
+        }
+        else if (arg == "--pipeline-threads" && i + 1 < argc) {
+            settings.pipelineCompileThreads = triangle::parseArgument<uint32_t>(arg, argv[++i]);
+        }
+        else if (arg == "--shader-dir" && i + 1 < argc) {
+            settings.shaderDirectory = argv[++i];
+        }
+        else if (arg == "--hot-reload") {
+            settings.hotReload = true;
+        }
+        else if (arg == "--shader-source" && i + 1 < argc) {
+            settings.shaderSourceDirectory = argv[++i];
+        }
+        else if (arg == "--pacing" && i + 1 < argc) {
+            std::string profile = argv[++i];
+            if (profile == "low-latency") {
+                settings.pacingProfile = triangle::PacingProfile::LowLatency;
+            }
+            else if (profile == "smooth") {
+                settings.pacingProfile = triangle::PacingProfile::Smooth;
+            }
+            else if (profile == "throughput") {
+                settings.pacingProfile = triangle::PacingProfile::Throughput;
+            }
+            else {
+                std::cerr << "Unknown pacing profile: " << profile << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--fps-limit" && i + 1 < argc) {
+            settings.targetFrameRate = triangle::parseArgument<double>(arg, argv[++i]);
+        }
+        else if (arg == "--adaptive-sleep") {
+            settings.adaptiveFrameSleep = true;
+        }
+        else if (arg == "--color-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "vertex") {
+                settings.colorMode = triangle::ColorMode::Vertex;
+            }
+            else if (mode == "luminance") {
+                settings.colorMode = triangle::ColorMode::Luminance;
+            }
+            else if (mode == "flat") {
+                settings.colorMode = triangle::ColorMode::Flat;
+            }
+            else {
+                std::cerr << "Unknown color mode: " << mode << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--mesh" && i + 1 < argc) {
+            settings.meshPath = argv[++i];
+        }
+        else if (arg == "--no-mesh-optimize") {
+            settings.optimizeMesh = false;
+        }
+        else if (arg == "--width" && i + 1 < argc) {
+            settings.width = triangle::parseArgument<int>(arg, argv[++i]);
+        }
+        else if (arg == "--height" && i + 1 < argc) {
+            settings.height = triangle::parseArgument<int>(arg, argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] <<
+                " [--headless] [--frames N] [--frames-in-flight N] [--recording-threads N]" <<
+                " [--instances N] [--gpu-culling] [--no-async-queues] [--no-dynamic-rendering] [--pipeline-cache FILE] [--pipeline-threads N]" <<
+                " [--shader-dir DIR] [--hot-reload [--shader-source DIR]]" <<
+                " [--color-mode vertex|luminance|flat] [--pacing low-latency|smooth|throughput]" <<
+                " [--fps-limit FPS] [--adaptive-sleep]" <<
+                " [--mesh FILE] [--no-mesh-optimize] [--width W] [--height H]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     try {
+        triangle::TriangleApplication app(settings);
+
+        if (instanceCount > 1) {
+            app.setInstances(triangle::generateInstanceGrid(instanceCount));
+            app.setDrawList({{static_cast<uint32_t>(app.getMesh().indices.size()), instanceCount, 0, 0, 0}});
+        }
+
         app.run();
     }
     catch (std::exception &ex) {
@@ -21,4 +135,4 @@ int main(int argc, char** argv) {
     }
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
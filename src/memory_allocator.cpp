@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <stdexcept>
+#include <memory_allocator.hpp>
+
+using namespace triangle;
+
+MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize) {
+    this->device = device;
+    this->totalAllocations = 0;
+    this->totalFrees = 0;
+
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &this->memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    this->maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    // Blocks are split by halving, so their size must be a power of two
+    this->blockSize = minimumAllocation << orderForSize(blockSize);
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    for (auto& pool : this->pools){
+        for (auto& block : pool.second){
+            this->destroyBlock(block.get());
+        }
+    }
+}
+
+Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind){
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    uint32_t memoryTypeIndex = this->findMemoryType(requirements.memoryTypeBits, properties);
+    uint32_t poolKey = memoryTypeIndex * 2 + (kind == ResourceKind::Optimal ? 1 : 0);
+
+    // Buddy ranges are aligned to their own size, so a large enough order satisfies any alignment
+    uint32_t order = std::max(orderForSize(requirements.size), orderForSize(requirements.alignment));
+
+    std::vector<std::unique_ptr<Block>>& pool = this->pools[poolKey];
+
+    Block* target = nullptr;
+    VkDeviceSize offset = 0;
+
+    for (auto& block : pool){
+        if (this->allocateFromBlock(block.get(), order, offset)){
+            target = block.get();
+            break;
+        }
+    }
+
+    if (target == nullptr){
+        // Small heaps (integrated or software devices) get proportionally smaller blocks
+        uint32_t heapIndex = this->memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        VkDeviceSize heapSize = this->memoryProperties.memoryHeaps[heapIndex].size;
+
+        VkDeviceSize size = this->blockSize;
+        while (size > minimumAllocation && size > heapSize / 8){
+            size /= 2;
+        }
+        size = std::max(size, minimumAllocation << order);
+
+        // Reserve first so adding the block cannot throw after its memory is allocated
+        pool.reserve(pool.size() + 1);
+        pool.push_back(this->createBlock(poolKey, memoryTypeIndex, size));
+        target = pool.back().get();
+
+        if (!this->allocateFromBlock(target, order, offset)){
+            throw std::runtime_error("Failed to sub-allocate from a new memory block");
+        }
+    }
+
+    target->allocationCount++;
+    target->bytesUsed += requirements.size;
+    target->bytesReserved += minimumAllocation << order;
+    this->totalAllocations++;
+
+    Allocation allocation;
+    allocation.memory = target->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mappedData = target->mappedData != nullptr ? target->mappedData + offset : nullptr;
+    allocation.block = target;
+    allocation.order = order;
+
+    return allocation;
+}
+
+void MemoryAllocator::free(Allocation& allocation){
+    if (allocation.block == nullptr){
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    Block* block = static_cast<Block*>(allocation.block);
+    this->freeToBlock(block, allocation.offset, allocation.order);
+
+    block->allocationCount--;
+    block->bytesUsed -= allocation.size;
+    block->bytesReserved -= minimumAllocation << allocation.order;
+    this->totalFrees++;
+
+    // Keep one empty block per pool around so alternating alloc/free does not thrash the driver
+    std::vector<std::unique_ptr<Block>>& pool = this->pools[block->poolKey];
+    bool redundant = block->allocationCount == 0 &&
+        std::any_of(pool.begin(), pool.end(), [block](const std::unique_ptr<Block>& candidate){
+            return candidate.get() != block && candidate->allocationCount == 0;
+        });
+    if (redundant){
+        this->destroyBlock(block);
+        pool.erase(std::find_if(pool.begin(), pool.end(), [block](const std::unique_ptr<Block>& candidate){
+            return candidate.get() == block;
+        }));
+    }
+
+    allocation = Allocation{};
+}
+
+void MemoryAllocator::createBuffer(
+    const VkBufferCreateInfo& bufferInfo,
+    VkMemoryPropertyFlags properties,
+    VkBuffer& buffer,
+    Allocation& allocation
+){
+    if (vkCreateBuffer(this->device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create buffer");
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(this->device, buffer, &memoryRequirements);
+
+    allocation = this->allocate(memoryRequirements, properties, ResourceKind::Linear);
+    vkBindBufferMemory(this->device, buffer, allocation.memory, allocation.offset);
+}
+
+void MemoryAllocator::createImage(
+    const VkImageCreateInfo& imageInfo,
+    VkMemoryPropertyFlags properties,
+    VkImage& image,
+    Allocation& allocation
+){
+    if (vkCreateImage(this->device, &imageInfo, nullptr, &image) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create image");
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(this->device, image, &memoryRequirements);
+
+    ResourceKind kind = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal : ResourceKind::Linear;
+    allocation = this->allocate(memoryRequirements, properties, kind);
+    vkBindImageMemory(this->device, image, allocation.memory, allocation.offset);
+}
+
+void MemoryAllocator::destroyBuffer(VkBuffer buffer, Allocation& allocation){
+    vkDestroyBuffer(this->device, buffer, nullptr);
+    this->free(allocation);
+}
+
+void MemoryAllocator::destroyImage(VkImage image, Allocation& allocation){
+    vkDestroyImage(this->device, image, nullptr);
+    this->free(allocation);
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for(uint32_t i = 0; i < this->memoryProperties.memoryTypeCount; i++){
+        if (typeFilter & (1 << i) &&
+            (this->memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type");
+}
+
+MemoryAllocator::Stats MemoryAllocator::getStats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    Stats stats;
+    stats.totalAllocations = this->totalAllocations;
+    stats.totalFrees = this->totalFrees;
+
+    VkDeviceSize bytesFree = 0;
+
+    for (const auto& pool : this->pools){
+        for (const auto& block : pool.second){
+            stats.blockCount++;
+            stats.bytesAllocated += block->size;
+            stats.allocationCount += block->allocationCount;
+            stats.bytesUsed += block->bytesUsed;
+            stats.bytesReserved += block->bytesReserved;
+
+            bytesFree += block->size - block->bytesReserved;
+
+            for (uint32_t order = block->maxOrder + 1; order > 0; order--){
+                if (!block->freeLists[order - 1].empty()){
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, minimumAllocation << (order - 1));
+                    break;
+                }
+            }
+        }
+    }
+
+    if (bytesFree > 0){
+        stats.fragmentation = 1.0 - static_cast<double>(stats.largestFreeRange) / static_cast<double>(bytesFree);
+    }
+
+    return stats;
+}
+
+std::unique_ptr<MemoryAllocator::Block> MemoryAllocator::createBlock(uint32_t poolKey, uint32_t memoryTypeIndex, VkDeviceSize size){
+    uint32_t blockCount = 0;
+    for (const auto& pool : this->pools){
+        blockCount += static_cast<uint32_t>(pool.second.size());
+    }
+
+    if (blockCount >= this->maxAllocationCount){
+        throw std::runtime_error("Exceeded maxMemoryAllocationCount");
+    }
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(this->device, &allocInfo, nullptr, &memory) != VK_SUCCESS){
+        throw std::runtime_error("Failed to allocate device memory block");
+    }
+
+    auto block = std::make_unique<Block>();
+    block->memory = memory;
+    block->size = size;
+    block->mappedData = nullptr;
+    block->poolKey = poolKey;
+    block->maxOrder = orderForSize(size);
+    block->freeLists.resize(block->maxOrder + 1);
+    block->freeLists[block->maxOrder].insert(0);
+    block->allocationCount = 0;
+    block->bytesUsed = 0;
+    block->bytesReserved = 0;
+
+    // Host-visible blocks are mapped once and handed out as persistent pointers
+    if (this->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT){
+        void* data;
+        if (vkMapMemory(this->device, memory, 0, size, 0, &data) != VK_SUCCESS){
+            vkFreeMemory(this->device, memory, nullptr);
+            throw std::runtime_error("Failed to map device memory block");
+        }
+        block->mappedData = static_cast<char*>(data);
+    }
+
+    return block;
+}
+
+void MemoryAllocator::destroyBlock(Block* block){
+    if (block->mappedData != nullptr){
+        vkUnmapMemory(this->device, block->memory);
+    }
+    vkFreeMemory(this->device, block->memory, nullptr);
+}
+
+bool MemoryAllocator::allocateFromBlock(Block* block, uint32_t order, VkDeviceSize& offset){
+    if (order > block->maxOrder){
+        return false;
+    }
+
+    uint32_t available = order;
+    while (available <= block->maxOrder && block->freeLists[available].empty()){
+        available++;
+    }
+
+    if (available > block->maxOrder){
+        return false;
+    }
+
+    offset = *block->freeLists[available].begin();
+    block->freeLists[available].erase(block->freeLists[available].begin());
+
+    // Split down to the requested size, returning the upper halves to the free lists
+    while (available > order){
+        available--;
+        block->freeLists[available].insert(offset + (minimumAllocation << available));
+    }
+
+    return true;
+}
+
+void MemoryAllocator::freeToBlock(Block* block, VkDeviceSize offset, uint32_t order){
+    // Merge with the buddy for as long as it is also free
+    while (order < block->maxOrder){
+        VkDeviceSize buddy = offset ^ (minimumAllocation << order);
+        auto it = block->freeLists[order].find(buddy);
+
+        if (it == block->freeLists[order].end()){
+            break;
+        }
+
+        block->freeLists[order].erase(it);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+
+    block->freeLists[order].insert(offset);
+}
+
+uint32_t MemoryAllocator::orderForSize(VkDeviceSize size){
+    uint32_t order = 0;
+    while ((minimumAllocation << order) < size){
+        order++;
+    }
+    return order;
+}
@@ -0,0 +1,328 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <mesh.hpp>
+
+using namespace triangle;
+
+namespace {
+    const char meshMagic[4] = {'T', 'R', 'I', 'M'};
+    const uint32_t meshVersion = 1;
+
+    struct MeshHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+    };
+
+    static_assert(sizeof(Vertex) == 5 * sizeof(float), "Mesh files store tightly packed vertices");
+
+    // Scoring constants from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    const float cacheDecayPower = 1.5f;
+    const float lastTriangleScore = 0.75f;
+    const float valenceBoostScale = 2.0f;
+    const float valenceBoostPower = 0.5f;
+
+    float vertexScore(int cachePosition, uint32_t remainingTriangles, uint32_t cacheSize){
+        if (remainingTriangles == 0){
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0){
+            if (cachePosition < 3){
+                // The last triangle's vertices get a fixed score so it is not simply repeated
+                score = lastTriangleScore;
+            }
+            else {
+                float scaler = 1.0f / (cacheSize - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scaler, cacheDecayPower);
+            }
+        }
+
+        // Favour vertices with few triangles left so they can be retired early
+        score += valenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -valenceBoostPower);
+        return score;
+    }
+}
+
+Mesh Mesh::load(const std::string& path){
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open()){
+        throw std::runtime_error("Failed to open mesh: " + path);
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    MeshHeader header;
+    if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        throw std::runtime_error("Mesh is missing its header: " + path);
+    }
+
+    if (std::memcmp(header.magic, meshMagic, sizeof(meshMagic)) != 0 || header.version != meshVersion){
+        throw std::runtime_error("Unsupported mesh format: " + path);
+    }
+
+    size_t expectedSize = sizeof(header) +
+        static_cast<size_t>(header.vertexCount) * sizeof(Vertex) +
+        static_cast<size_t>(header.indexCount) * sizeof(uint32_t);
+
+    if (fileSize != expectedSize || header.indexCount == 0 || header.indexCount % 3 != 0){
+        throw std::runtime_error("Mesh is truncated or malformed: " + path);
+    }
+
+    Mesh mesh;
+    mesh.vertices.resize(header.vertexCount);
+    mesh.indices.resize(header.indexCount);
+
+    file.read(reinterpret_cast<char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+    file.read(reinterpret_cast<char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+
+    for (uint32_t index : mesh.indices){
+        if (index >= header.vertexCount){
+            throw std::runtime_error("Mesh index out of range: " + path);
+        }
+    }
+
+    return mesh;
+}
+
+void Mesh::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()){
+        throw std::runtime_error("Failed to write mesh: " + path);
+    }
+
+    MeshHeader header;
+    std::memcpy(header.magic, meshMagic, sizeof(meshMagic));
+    header.version = meshVersion;
+    header.vertexCount = static_cast<uint32_t>(this->vertices.size());
+    header.indexCount = static_cast<uint32_t>(this->indices.size());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(this->vertices.data()), this->vertices.size() * sizeof(Vertex));
+    file.write(reinterpret_cast<const char*>(this->indices.data()), this->indices.size() * sizeof(uint32_t));
+}
+
+VkIndexType Mesh::getIndexType() const {
+    return this->vertices.size() <= 0x10000 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+size_t Mesh::getTriangleCount() const {
+    return this->indices.size() / 3;
+}
+
+float Mesh::getBoundingRadius() const {
+    float radius = 0.0f;
+    for (const Vertex& vertex : this->vertices){
+        radius = std::max(radius, glm::length(vertex.pos));
+    }
+    return radius;
+}
+
+Mesh triangle::generateGridMesh(uint32_t columns, uint32_t rows){
+    Mesh mesh;
+    mesh.vertices.reserve(static_cast<size_t>(columns + 1) * (rows + 1));
+    mesh.indices.reserve(static_cast<size_t>(columns) * rows * 6);
+
+    for (uint32_t y = 0; y <= rows; y++){
+        for (uint32_t x = 0; x <= columns; x++){
+            float u = static_cast<float>(x) / columns;
+            float v = static_cast<float>(y) / rows;
+            mesh.vertices.push_back({{u * 2.0f - 1.0f, v * 2.0f - 1.0f}, {u, v, 1.0f - u}});
+        }
+    }
+
+    for (uint32_t y = 0; y < rows; y++){
+        for (uint32_t x = 0; x < columns; x++){
+            uint32_t topLeft = y * (columns + 1) + x;
+            uint32_t bottomLeft = topLeft + columns + 1;
+
+            mesh.indices.insert(mesh.indices.end(), {
+                topLeft, bottomLeft, topLeft + 1,
+                topLeft + 1, bottomLeft, bottomLeft + 1
+            });
+        }
+    }
+
+    return mesh;
+}
+
+std::vector<InstanceData> triangle::generateInstanceGrid(uint32_t count, float extent){
+    std::vector<InstanceData> instances;
+    instances.reserve(count);
+
+    uint32_t columns = 1;
+    // Squared in 64 bits so counts near the uint32_t limit cannot wrap and loop forever
+    while (static_cast<uint64_t>(columns) * columns < count){
+        columns++;
+    }
+
+    float cellSize = 2.0f * extent / columns;
+
+    for (uint32_t i = 0; i < count; i++){
+        uint32_t x = i % columns;
+        uint32_t y = i / columns;
+        float u = (x + 0.5f) / columns;
+        float v = (y + 0.5f) / columns;
+
+        instances.push_back({
+            {(u * 2.0f - 1.0f) * extent, (v * 2.0f - 1.0f) * extent, cellSize, 0.0f},
+            {1.0f - v, u, v, 1.0f}
+        });
+    }
+
+    return instances;
+}
+
+void triangle::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize){
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || cacheSize <= 3){
+        return;
+    }
+
+    // Triangle adjacency per vertex, stored as one flat array with per-vertex offsets
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices){
+        remaining[index]++;
+    }
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++){
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++){
+        for (size_t k = 0; k < 3; k++){
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++){
+        vertexScores[v] = vertexScore(-1, remaining[v], cacheSize);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++){
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+
+    // The cache holds three extra entries so the newest triangle never evicts candidates
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(cacheSize + 3);
+    nextCache.reserve(cacheSize + 3);
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    int64_t bestTriangle = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+    size_t scanCursor = 0;
+
+    while (output.size() < indices.size()){
+        if (bestTriangle < 0){
+            // Nothing in the cache touches an unemitted triangle; take the next one in input order
+            while (emitted[scanCursor]){
+                scanCursor++;
+            }
+            bestTriangle = static_cast<int64_t>(scanCursor);
+        }
+
+        size_t t = static_cast<size_t>(bestTriangle);
+        emitted[t] = true;
+
+        nextCache.clear();
+        for (size_t k = 0; k < 3; k++){
+            uint32_t v = indices[t * 3 + k];
+            output.push_back(v);
+            nextCache.push_back(v);
+
+            // Drop the emitted triangle from the vertex's adjacency
+            uint32_t begin = adjacencyOffset[v];
+            uint32_t end = begin + remaining[v];
+            for (uint32_t i = begin; i < end; i++){
+                if (adjacency[i] == t){
+                    adjacency[i] = adjacency[end - 1];
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        for (uint32_t v : cache){
+            if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2]){
+                nextCache.push_back(v);
+            }
+        }
+
+        // Vertices pushed past the end leave the cache
+        for (size_t i = cacheSize; i < nextCache.size(); i++){
+            cachePosition[nextCache[i]] = -1;
+            vertexScores[nextCache[i]] = vertexScore(-1, remaining[nextCache[i]], cacheSize);
+        }
+        if (nextCache.size() > cacheSize){
+            nextCache.resize(cacheSize);
+        }
+
+        for (size_t i = 0; i < nextCache.size(); i++){
+            uint32_t v = nextCache[i];
+            cachePosition[v] = static_cast<int>(i);
+            vertexScores[v] = vertexScore(static_cast<int>(i), remaining[v], cacheSize);
+        }
+
+        cache.swap(nextCache);
+
+        // Only triangles touching the cache can have changed score
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : cache){
+            uint32_t begin = adjacencyOffset[v];
+            for (uint32_t i = begin; i < begin + remaining[v]; i++){
+                uint32_t candidate = adjacency[i];
+                float score = vertexScores[indices[candidate * 3]] +
+                    vertexScores[indices[candidate * 3 + 1]] +
+                    vertexScores[indices[candidate * 3 + 2]];
+                triangleScores[candidate] = score;
+
+                if (score > bestScore){
+                    bestScore = score;
+                    bestTriangle = candidate;
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+double triangle::computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize){
+    if (indices.size() < 3){
+        return 0.0;
+    }
+
+    // FIFO replacement, as used by most fixed-size hardware post-transform caches
+    std::vector<uint64_t> insertedAt(vertexCount, 0);
+    uint64_t insertions = 0;
+    uint64_t misses = 0;
+
+    for (uint32_t index : indices){
+        if (insertedAt[index] == 0 || insertions - insertedAt[index] >= cacheSize){
+            insertions++;
+            insertedAt[index] = insertions;
+            misses++;
+        }
+    }
+
+    return static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+}
@@ -0,0 +1,175 @@
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pipeline_cache.hpp>
+
+using namespace triangle;
+
+PipelineCache::PipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path) {
+    this->device = device;
+    this->path = path;
+    this->warm = false;
+    this->loadedSize = 0;
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &this->deviceProperties);
+
+    std::vector<char> data;
+    if (!this->path.empty()){
+        std::ifstream file(this->path, std::ios::ate | std::ios::binary);
+
+        if (file.is_open()){
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), data.size());
+
+            if (!file || !this->validateHeader(data)){
+                data.clear();
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(this->device, &createInfo, nullptr, &this->cache) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create pipeline cache");
+    }
+
+    this->warm = !data.empty();
+    this->loadedSize = data.size();
+}
+
+PipelineCache::~PipelineCache() {
+    vkDestroyPipelineCache(this->device, this->cache, nullptr);
+}
+
+std::string PipelineCache::defaultPath(){
+    std::filesystem::path directory;
+
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (cacheHome != nullptr && cacheHome[0] != '\0'){
+        directory = cacheHome;
+    }
+    else if (home != nullptr && home[0] != '\0'){
+        directory = std::filesystem::path(home) / ".cache";
+    }
+    else {
+        return std::string();
+    }
+
+    return (directory / "vulkan-triangle" / "pipeline_cache.bin").string();
+}
+
+VkPipelineCache PipelineCache::get() const {
+    return this->cache;
+}
+
+bool PipelineCache::isWarm() const {
+    return this->warm;
+}
+
+size_t PipelineCache::getLoadedSize() const {
+    return this->loadedSize;
+}
+
+void PipelineCache::save(){
+    if (this->path.empty()){
+        return;
+    }
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(this->device, this->cache, &dataSize, nullptr) != VK_SUCCESS){
+        throw std::runtime_error("Failed to query pipeline cache size");
+    }
+
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(this->device, this->cache, &dataSize, data.data()) != VK_SUCCESS){
+        throw std::runtime_error("Failed to read pipeline cache data");
+    }
+    data.resize(dataSize);
+
+    std::filesystem::path directory = std::filesystem::path(this->path).parent_path();
+    if (directory.empty()){
+        directory = ".";
+    }
+
+    std::error_code directoryError;
+    std::filesystem::create_directories(directory, directoryError);
+    if (directoryError){
+        throw std::runtime_error("Failed to create pipeline cache directory: " + directory.string());
+    }
+
+    // Written to a temporary file and synced before the rename, and the directory synced after
+    // it, so a crash leaves either the old cache or the complete new one. The default path is
+    // shared by every process of the user, so each save gets its own uniquely named file.
+    std::string temporaryPattern = this->path + ".XXXXXX";
+    std::vector<char> temporaryName(temporaryPattern.begin(), temporaryPattern.end());
+    temporaryName.push_back('\0');
+    int fd = ::mkstemp(temporaryName.data());
+    if (fd < 0){
+        throw std::runtime_error("Failed to write pipeline cache: " + temporaryPattern);
+    }
+    std::string temporaryPath = temporaryName.data();
+
+    size_t written = 0;
+    while (written < data.size()){
+        ssize_t result = ::write(fd, data.data() + written, data.size() - written);
+        if (result < 0 && errno == EINTR){
+            continue;
+        }
+        if (result <= 0){
+            break;
+        }
+        written += static_cast<size_t>(result);
+    }
+
+    bool synced = written == data.size() && ::fsync(fd) == 0;
+    bool closed = ::close(fd) == 0;
+    if (!synced || !closed){
+        std::error_code error;
+        std::filesystem::remove(temporaryPath, error);
+        throw std::runtime_error("Failed to write pipeline cache: " + temporaryPath);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, this->path, error);
+    if (error){
+        std::filesystem::remove(temporaryPath, error);
+        throw std::runtime_error("Failed to replace pipeline cache: " + this->path);
+    }
+
+    int directoryFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd < 0){
+        throw std::runtime_error("Failed to sync pipeline cache directory: " + directory.string());
+    }
+
+    bool directorySynced = ::fsync(directoryFd) == 0;
+    ::close(directoryFd);
+    if (!directorySynced){
+        throw std::runtime_error("Failed to sync pipeline cache directory: " + directory.string());
+    }
+}
+
+bool PipelineCache::validateHeader(const std::vector<char>& data) const {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header)){
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+        header.headerSize <= data.size() &&
+        header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+        header.vendorID == this->deviceProperties.vendorID &&
+        header.deviceID == this->deviceProperties.deviceID &&
+        std::memcmp(header.pipelineCacheUUID, this->deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
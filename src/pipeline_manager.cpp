@@ -0,0 +1,129 @@
+#include <chrono>
+#include <stdexcept>
+#include <frame_stats.hpp>
+#include <pipeline_manager.hpp>
+
+using namespace triangle;
+
+PipelineManager::PipelineManager(VkDevice device, VkPipelineCache cache, size_t threadCount) {
+    this->device = device;
+    this->cache = cache;
+    this->nextHandle = 1;
+
+    if (threadCount > 0){
+        this->workers = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+PipelineManager::~PipelineManager() {
+    this->waitIdle();
+
+    for (auto& entry : this->pipelines){
+        try {
+            vkDestroyPipeline(this->device, entry.second.get(), nullptr);
+        }
+        catch (...) {
+            // The build failed, so there is nothing to destroy
+        }
+    }
+}
+
+PipelineManager::Handle PipelineManager::submit(BuildFunction build){
+    auto job = [this, build](){
+        auto start = FrameClock::now();
+
+        try {
+            VkPipeline pipeline = build(this->cache);
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stats.compiled++;
+            this->stats.compileMs += elapsedMilliseconds(start);
+            return pipeline;
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stats.failed++;
+            throw;
+        }
+    };
+
+    std::shared_future<VkPipeline> future;
+    if (this->workers){
+        future = this->workers->submit(job).share();
+    }
+    else {
+        std::packaged_task<VkPipeline()> task(job);
+        future = task.get_future().share();
+        task();
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Handle handle = this->nextHandle++;
+    this->pipelines[handle] = future;
+    this->stats.submitted++;
+
+    return handle;
+}
+
+VkPipeline PipelineManager::tryGet(Handle handle) const {
+    std::shared_future<VkPipeline> future = this->find(handle);
+
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+        return VK_NULL_HANDLE;
+    }
+    return future.get();
+}
+
+VkPipeline PipelineManager::wait(Handle handle) const {
+    return this->find(handle).get();
+}
+
+bool PipelineManager::isReady(Handle handle) const {
+    return this->find(handle).wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void PipelineManager::destroy(Handle handle){
+    std::shared_future<VkPipeline> future = this->find(handle);
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pipelines.erase(handle);
+    }
+
+    future.wait();
+    try {
+        vkDestroyPipeline(this->device, future.get(), nullptr);
+    }
+    catch (...) {
+        // The build failed, so there is nothing to destroy
+    }
+}
+
+void PipelineManager::waitIdle() const {
+    std::vector<std::shared_future<VkPipeline>> pending;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (const auto& entry : this->pipelines){
+            pending.push_back(entry.second);
+        }
+    }
+
+    for (const auto& future : pending){
+        future.wait();
+    }
+}
+
+PipelineManager::Stats PipelineManager::getStats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+std::shared_future<VkPipeline> PipelineManager::find(Handle handle) const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto it = this->pipelines.find(handle);
+    if (it == this->pipelines.end()){
+        throw std::runtime_error("Unknown pipeline handle");
+    }
+    return it->second;
+}
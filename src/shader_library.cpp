@@ -0,0 +1,327 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <filesystem>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// Not declared by <unistd.h> on every platform, macOS in particular
+extern char **environ;
+#else
+#include <process.h>
+#endif
+
+#include <frame_stats.hpp>
+#include <shader_library.hpp>
+
+using namespace triangle;
+
+#if defined(TRIANGLE_EMBED_SHADERS)
+namespace triangle {
+    extern const EmbeddedShader embeddedShaders[];
+    extern const size_t embeddedShaderCount;
+}
+#endif
+
+namespace {
+    const uint32_t spirvMagic = 0x07230203;
+
+    void validateSpirv(const uint32_t* code, size_t size, const std::string& name){
+        if (size < sizeof(uint32_t) || size % sizeof(uint32_t) != 0 || code[0] != spirvMagic){
+            std::stringstream ss;
+            ss << "Not a SPIR-V module: " << name;
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    // Runs a program found on the PATH with the given arguments, without going through a
+    // shell, and waits for it. Returns a description of how it failed, or an empty string.
+    std::string runProcess(const std::vector<std::string>& arguments){
+        std::vector<char*> argv;
+        for (const std::string& argument : arguments){
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        std::stringstream ss;
+
+#if !defined(_WIN32)
+        pid_t pid;
+        int error = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+        if (error != 0){
+            ss << "could not run " << arguments[0] << ": " << std::strerror(error);
+            return ss.str();
+        }
+
+        int status;
+        while (waitpid(pid, &status, 0) < 0){
+            if (errno != EINTR){
+                ss << "could not wait for " << arguments[0] << ": " << std::strerror(errno);
+                return ss.str();
+            }
+        }
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) != 0){
+            ss << arguments[0] << " exited with status " << WEXITSTATUS(status);
+        }
+        else if (WIFSIGNALED(status)){
+            ss << arguments[0] << " was terminated by signal " << WTERMSIG(status);
+        }
+#else
+        intptr_t status = _spawnvp(_P_WAIT, argv[0], argv.data());
+        if (status < 0){
+            ss << "could not run " << arguments[0] << ": " << std::strerror(errno);
+        }
+        else if (status != 0){
+            ss << arguments[0] << " exited with status " << status;
+        }
+#endif
+
+        return ss.str();
+    }
+}
+
+ShaderBlob::~ShaderBlob() {
+    this->release();
+}
+
+ShaderBlob::ShaderBlob(ShaderBlob&& other) noexcept {
+    *this = std::move(other);
+}
+
+ShaderBlob& ShaderBlob::operator=(ShaderBlob&& other) noexcept {
+    if (this != &other){
+        this->release();
+
+        this->words = std::exchange(other.words, nullptr);
+        this->bytes = std::exchange(other.bytes, 0);
+        this->mapping = std::exchange(other.mapping, nullptr);
+        this->mappingSize = std::exchange(other.mappingSize, 0);
+        this->storage = std::move(other.storage);
+    }
+
+    return *this;
+}
+
+void ShaderBlob::release() {
+#if !defined(_WIN32)
+    if (this->mapping != nullptr){
+        munmap(this->mapping, this->mappingSize);
+    }
+#endif
+
+    this->words = nullptr;
+    this->bytes = 0;
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->storage.clear();
+}
+
+ShaderBlob ShaderBlob::mapFile(const std::string& path) {
+    ShaderBlob blob;
+
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0){
+        std::stringstream ss;
+        ss << "Failed to open file: " << path;
+        throw std::runtime_error(ss.str());
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0){
+        close(fd);
+
+        std::stringstream ss;
+        ss << "Failed to read file: " << path;
+        throw std::runtime_error(ss.str());
+    }
+
+    // Mappings are page aligned, so the words can go straight to the driver without a copy
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED){
+        std::stringstream ss;
+        ss << "Failed to map file: " << path;
+        throw std::runtime_error(ss.str());
+    }
+
+    blob.mapping = mapping;
+    blob.mappingSize = size;
+    blob.words = static_cast<const uint32_t*>(mapping);
+    blob.bytes = size;
+#else
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open()){
+        std::stringstream ss;
+        ss << "Failed to open file: " << path;
+        throw std::runtime_error(ss.str());
+    }
+
+    // Read into words rather than chars so the code is suitably aligned
+    size_t size = static_cast<size_t>(file.tellg());
+    blob.storage.resize((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(blob.storage.data()), size);
+
+    blob.words = blob.storage.data();
+    blob.bytes = size;
+#endif
+
+    validateSpirv(blob.words, blob.bytes, path);
+    return blob;
+}
+
+ShaderBlob ShaderBlob::fromStatic(const uint32_t* code, size_t size) {
+    ShaderBlob blob;
+    blob.words = code;
+    blob.bytes = size;
+    return blob;
+}
+
+const uint32_t* ShaderBlob::code() const {
+    return this->words;
+}
+
+size_t ShaderBlob::size() const {
+    return this->bytes;
+}
+
+ShaderLibrary::ShaderLibrary(const std::string& directory) {
+#if !defined(TRIANGLE_EMBED_SHADERS)
+    this->directory = directory.empty() ? findShaderDirectory() : directory;
+#else
+    (void)directory;
+#endif
+}
+
+std::string ShaderLibrary::findShaderDirectory() {
+    namespace fs = std::filesystem;
+    std::error_code error;
+
+    // Prefer shaders installed next to the executable, so it runs from any working directory
+#if defined(__linux__)
+    fs::path executable = fs::read_symlink("/proc/self/exe", error);
+    if (!error){
+        fs::path candidate = executable.parent_path() / "shaders";
+        if (fs::is_directory(candidate, error)){
+            return candidate.string();
+        }
+    }
+#endif
+
+#if defined(TRIANGLE_SHADER_DIR)
+    if (fs::is_directory(TRIANGLE_SHADER_DIR, error)){
+        return TRIANGLE_SHADER_DIR;
+    }
+#endif
+
+    return "shaders";
+}
+
+ShaderBlob ShaderLibrary::load(const std::string& name) {
+    auto loadStart = FrameClock::now();
+    ShaderBlob blob;
+
+#if defined(TRIANGLE_EMBED_SHADERS)
+    for (size_t i = 0; i < embeddedShaderCount; i++){
+        if (name == embeddedShaders[i].name){
+            blob = ShaderBlob::fromStatic(embeddedShaders[i].code, embeddedShaders[i].size);
+            break;
+        }
+    }
+
+    if (blob.code() == nullptr){
+        std::stringstream ss;
+        ss << "Shader is not embedded in the executable: " << name;
+        throw std::runtime_error(ss.str());
+    }
+
+    validateSpirv(blob.code(), blob.size(), name);
+#else
+    blob = ShaderBlob::mapFile((std::filesystem::path(this->directory) / (name + ".spv")).string());
+#endif
+
+    double loadMs = elapsedMilliseconds(loadStart);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.shadersLoaded++;
+    this->stats.bytesLoaded += blob.size();
+    this->stats.loadMs += loadMs;
+
+    return blob;
+}
+
+void ShaderLibrary::compile(const std::string& sourceDirectory, const std::string& name) {
+    if (this->getSource() == Source::Embedded){
+        throw std::runtime_error("Cannot recompile shaders embedded in the executable");
+    }
+
+#if defined(TRIANGLE_GLSLC)
+    std::string compiler = TRIANGLE_GLSLC;
+#else
+    std::string compiler = "glslc";
+#endif
+
+    namespace fs = std::filesystem;
+    fs::path source = fs::path(sourceDirectory) / name;
+    fs::path output = fs::path(this->directory) / (name + ".spv");
+
+    // Concurrent compiles of the same shader each write their own file, and the last rename wins
+    static std::atomic<uint64_t> compileCount{0};
+    std::stringstream temporaryName;
+    temporaryName << name << ".spv." << compileCount.fetch_add(1) << ".tmp";
+    fs::path temporary = fs::path(this->directory) / temporaryName.str();
+
+    std::string failure = runProcess({compiler, "-o", temporary.string(), source.string()});
+    if (!failure.empty()){
+        std::remove(temporary.string().c_str());
+
+        std::stringstream ss;
+        ss << "Failed to compile shader " << source.string() << ": " << failure;
+        throw std::runtime_error(ss.str());
+    }
+
+    std::error_code error;
+    fs::rename(temporary, output, error);
+    if (error){
+        std::remove(temporary.string().c_str());
+
+        std::stringstream ss;
+        ss << "Failed to replace shader: " << output.string();
+        throw std::runtime_error(ss.str());
+    }
+}
+
+ShaderLibrary::Source ShaderLibrary::getSource() const {
+#if defined(TRIANGLE_EMBED_SHADERS)
+    return Source::Embedded;
+#else
+    return Source::Mapped;
+#endif
+}
+
+const std::string& ShaderLibrary::getDirectory() const {
+    return this->directory;
+}
+
+ShaderLibrary::Stats ShaderLibrary::getStats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
@@ -0,0 +1,78 @@
+#include <cstring>
+#include <shader_variant.hpp>
+
+using namespace triangle;
+
+ShaderVariant& ShaderVariant::set(uint32_t constantId, uint32_t value) {
+    this->values[constantId] = value;
+    this->rebuild();
+    return *this;
+}
+
+ShaderVariant& ShaderVariant::set(uint32_t constantId, int32_t value) {
+    uint32_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    return this->set(constantId, word);
+}
+
+ShaderVariant& ShaderVariant::set(uint32_t constantId, float value) {
+    uint32_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    return this->set(constantId, word);
+}
+
+ShaderVariant& ShaderVariant::set(uint32_t constantId, bool value) {
+    // Boolean constants are read as a VkBool32
+    return this->set(constantId, static_cast<uint32_t>(value ? VK_TRUE : VK_FALSE));
+}
+
+void ShaderVariant::rebuild() {
+    this->entries.clear();
+    this->data.clear();
+
+    for (const auto& value : this->values){
+        VkSpecializationMapEntry entry = {};
+        entry.constantID = value.first;
+        entry.offset = static_cast<uint32_t>(this->data.size() * sizeof(uint32_t));
+        entry.size = sizeof(uint32_t);
+
+        this->entries.push_back(entry);
+        this->data.push_back(value.second);
+    }
+}
+
+VkSpecializationInfo ShaderVariant::getSpecializationInfo() const {
+    VkSpecializationInfo info = {};
+    info.mapEntryCount = static_cast<uint32_t>(this->entries.size());
+    info.pMapEntries = this->entries.empty() ? nullptr : this->entries.data();
+    info.dataSize = this->data.size() * sizeof(uint32_t);
+    info.pData = this->data.empty() ? nullptr : this->data.data();
+
+    return info;
+}
+
+size_t ShaderVariant::hash() const {
+    // FNV-1a over the (id, value) pairs, which the map keeps in id order
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint32_t word){
+        for (int i = 0; i < 4; i++){
+            hash ^= (word >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (const auto& value : this->values){
+        mix(value.first);
+        mix(value.second);
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+bool ShaderVariant::operator==(const ShaderVariant& other) const {
+    return this->values == other.values;
+}
+
+bool ShaderVariant::operator!=(const ShaderVariant& other) const {
+    return !(*this == other);
+}
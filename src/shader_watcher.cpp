@@ -0,0 +1,123 @@
+#include <stdexcept>
+#include <sstream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <shader_watcher.hpp>
+
+using namespace triangle;
+
+namespace {
+    // "triangle.frag.spv" and "triangle.frag" both map to "triangle.frag"; anything that is
+    // not a shader (editor swap files, the pipeline cache, ...) maps to an empty name
+    std::string shaderName(const std::string& fileName){
+        static const char* stages[] = {".vert", ".frag", ".comp", ".geom", ".tesc", ".tese"};
+
+        std::string name = fileName;
+        const std::string spirv = ".spv";
+        if (name.size() > spirv.size() && name.compare(name.size() - spirv.size(), spirv.size(), spirv) == 0){
+            name.resize(name.size() - spirv.size());
+        }
+
+        for (const char* stage : stages){
+            std::string extension = stage;
+            if (name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0){
+                return name;
+            }
+        }
+        return "";
+    }
+}
+
+ShaderWatcher::ShaderWatcher(const std::string& directory, double settleMs) {
+    this->directory = directory;
+    this->settleMs = settleMs;
+    this->fd = -1;
+    this->watch = -1;
+
+#if defined(__linux__)
+    this->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->fd < 0){
+        throw std::runtime_error("Failed to initialize inotify");
+    }
+
+    // Watch the directory rather than the files, so editors that save by renaming a new
+    // file over the old one are still seen
+    this->watch = inotify_add_watch(this->fd, this->directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (this->watch < 0){
+        close(this->fd);
+
+        std::stringstream ss;
+        ss << "Failed to watch shader directory: " << this->directory;
+        throw std::runtime_error(ss.str());
+    }
+
+    this->eventBuffer.resize(16 * 1024);
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher() {
+#if defined(__linux__)
+    if (this->fd >= 0){
+        close(this->fd);
+    }
+#endif
+}
+
+void ShaderWatcher::readEvents() {
+#if defined(__linux__)
+    while (true){
+        ssize_t length = read(this->fd, this->eventBuffer.data(), this->eventBuffer.size());
+        if (length <= 0){
+            // EAGAIN once the queue is drained
+            break;
+        }
+
+        auto now = FrameClock::now();
+        for (ssize_t offset = 0; offset < length; ){
+            auto event = reinterpret_cast<const inotify_event*>(this->eventBuffer.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->len == 0){
+                continue;
+            }
+
+            std::string name = shaderName(event->name);
+            if (!name.empty()){
+                this->pending[name] = now;
+            }
+        }
+    }
+#endif
+}
+
+std::set<std::string> ShaderWatcher::poll() {
+    this->readEvents();
+
+    std::set<std::string> settled;
+    auto now = FrameClock::now();
+
+    for (auto it = this->pending.begin(); it != this->pending.end(); ){
+        if (elapsedMilliseconds(it->second, now) >= this->settleMs){
+            settled.insert(it->first);
+            it = this->pending.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    return settled;
+}
+
+bool ShaderWatcher::isActive() const {
+    return this->watch >= 0;
+}
+
+const std::string& ShaderWatcher::getDirectory() const {
+    return this->directory;
+}
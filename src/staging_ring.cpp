@@ -0,0 +1,352 @@
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <staging_ring.hpp>
+
+using namespace triangle;
+
+StagingRing::StagingRing(
+    VkDevice device,
+    VkQueue queue,
+    uint32_t queueFamilyIndex,
+    uint32_t dstQueueFamilyIndex,
+    VkBuffer buffer,
+    void* mappedData,
+    VkDeviceSize capacity
+) {
+    this->device = device;
+    this->queue = queue;
+    this->queueFamilyIndex = queueFamilyIndex;
+    this->dstQueueFamilyIndex = dstQueueFamilyIndex;
+    this->buffer = buffer;
+    this->mappedData = static_cast<char*>(mappedData);
+    this->capacity = capacity;
+
+    this->head = 0;
+    this->inUse = 0;
+    this->pending = {0, VK_NULL_HANDLE, 0};
+
+    this->submittedValue = 0;
+    this->acquiredValue = 0;
+
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semInfo = {};
+    semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(this->device, &semInfo, nullptr, &this->semaphore) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create staging timeline semaphore");
+    }
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(this->device, &poolInfo, nullptr, &this->commandPool) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create staging command pool");
+    }
+}
+
+StagingRing::~StagingRing() {
+    // Submit uploads still being batched instead of dropping them
+    try {
+        this->flush();
+        this->waitIdle();
+    }
+    catch (std::exception &ex) {
+        std::cerr << "Failed to finish staging uploads: " << ex.what() << std::endl;
+    }
+
+    vkDestroySemaphore(this->device, this->semaphore, nullptr);
+
+    // Destroying the pool frees every command buffer allocated from it
+    vkDestroyCommandPool(this->device, this->commandPool, nullptr);
+}
+
+void StagingRing::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, bool concurrent){
+    const char* source = static_cast<const char*>(data);
+
+    // Keep chunks well under the ring size so one upload never has to drain the whole ring
+    VkDeviceSize maxChunk = std::max<VkDeviceSize>(this->capacity / 4, 1);
+
+    VkDeviceSize copied = 0;
+    while (copied < size){
+        VkDeviceSize chunk = std::min(maxChunk, size - copied);
+
+        VkDeviceSize offset = this->allocate(chunk, 16);
+        std::memcpy(this->mappedData + offset, source + copied, static_cast<size_t>(chunk));
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset = offset;
+        copyRegion.dstOffset = dstOffset + copied;
+        copyRegion.size = chunk;
+        vkCmdCopyBuffer(this->currentCommandBuffer(), this->buffer, dstBuffer, 1, &copyRegion);
+
+        if (!concurrent && this->queueFamilyIndex != this->dstQueueFamilyIndex){
+            // Consecutive chunks of one upload share a single transfer
+            bool extended = false;
+            if (!this->pendingTransfers.empty()){
+                VkBufferMemoryBarrier& last = this->pendingTransfers.back();
+                if (last.buffer == dstBuffer && last.offset + last.size == copyRegion.dstOffset){
+                    last.size += chunk;
+                    extended = true;
+                }
+            }
+
+            if (!extended){
+                VkBufferMemoryBarrier transfer = {};
+                transfer.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                transfer.srcQueueFamilyIndex = this->queueFamilyIndex;
+                transfer.dstQueueFamilyIndex = this->dstQueueFamilyIndex;
+                transfer.buffer = dstBuffer;
+                transfer.offset = copyRegion.dstOffset;
+                transfer.size = chunk;
+                this->pendingTransfers.push_back(transfer);
+            }
+        }
+
+        copied += chunk;
+        this->stats.bytesUploaded += chunk;
+    }
+}
+
+void StagingRing::flush(){
+    if (this->pending.commandBuffer == VK_NULL_HANDLE){
+        return;
+    }
+
+    if (this->queueFamilyIndex == this->dstQueueFamilyIndex){
+        // Make the copies available to any later use of the destination buffers
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            this->pending.commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+    else if (!this->pendingTransfers.empty()){
+        // Release ownership; the semaphore carries the dependency to the consuming queue
+        for (VkBufferMemoryBarrier& transfer : this->pendingTransfers){
+            transfer.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            transfer.dstAccessMask = 0;
+        }
+
+        vkCmdPipelineBarrier(
+            this->pending.commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(this->pendingTransfers.size()), this->pendingTransfers.data(),
+            0, nullptr
+        );
+
+        this->unacquiredTransfers.insert(
+            this->unacquiredTransfers.end(),
+            this->pendingTransfers.begin(),
+            this->pendingTransfers.end()
+        );
+        this->pendingTransfers.clear();
+    }
+
+    if (vkEndCommandBuffer(this->pending.commandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to record staging command buffer");
+    }
+
+    this->pending.value = this->submittedValue + 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &this->pending.value;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &this->pending.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &this->semaphore;
+
+    if (vkQueueSubmit(this->queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS){
+        throw std::runtime_error("Failed to submit staging copies");
+    }
+
+    this->submittedValue = this->pending.value;
+    this->inFlight.push_back(this->pending);
+    this->pending = {0, VK_NULL_HANDLE, 0};
+    this->stats.batchesSubmitted++;
+}
+
+void StagingRing::forget(VkBuffer dstBuffer){
+    auto targets = [dstBuffer](const VkBufferMemoryBarrier& transfer){
+        return transfer.buffer == dstBuffer;
+    };
+
+    this->pendingTransfers.erase(
+        std::remove_if(this->pendingTransfers.begin(), this->pendingTransfers.end(), targets),
+        this->pendingTransfers.end()
+    );
+    this->unacquiredTransfers.erase(
+        std::remove_if(this->unacquiredTransfers.begin(), this->unacquiredTransfers.end(), targets),
+        this->unacquiredTransfers.end()
+    );
+}
+
+uint64_t StagingRing::acquire(VkCommandBuffer commandBuffer){
+    if (this->acquiredValue == this->submittedValue){
+        return 0;
+    }
+
+    if (!this->unacquiredTransfers.empty()){
+        for (VkBufferMemoryBarrier& transfer : this->unacquiredTransfers){
+            transfer.srcAccessMask = 0;
+            transfer.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        }
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(this->unacquiredTransfers.size()), this->unacquiredTransfers.data(),
+            0, nullptr
+        );
+        this->unacquiredTransfers.clear();
+    }
+
+    this->acquiredValue = this->submittedValue;
+    return this->acquiredValue;
+}
+
+void StagingRing::reclaim(){
+    if (this->inFlight.empty()){
+        return;
+    }
+
+    uint64_t completedValue = 0;
+    if (vkGetSemaphoreCounterValue(this->device, this->semaphore, &completedValue) != VK_SUCCESS){
+        throw std::runtime_error("Failed to read staging timeline semaphore");
+    }
+
+    while (!this->inFlight.empty() && this->inFlight.front().value <= completedValue){
+        this->retireOldest();
+    }
+}
+
+void StagingRing::waitIdle(){
+    while (!this->inFlight.empty()){
+        this->retireOldest();
+    }
+}
+
+VkSemaphore StagingRing::getSemaphore() const {
+    return this->semaphore;
+}
+
+const StagingRing::Stats& StagingRing::getStats() const {
+    return this->stats;
+}
+
+VkDeviceSize StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment){
+    if (size > this->capacity){
+        throw std::runtime_error("Staging allocation is larger than the ring");
+    }
+
+    while (true){
+        if (this->inUse == 0){
+            this->head = 0;
+        }
+
+        VkDeviceSize aligned = (this->head + alignment - 1) / alignment * alignment;
+        VkDeviceSize offset = aligned;
+        VkDeviceSize needed = aligned - this->head + size;
+
+        // Skip the tail end of the ring when the allocation does not fit before wrapping
+        if (aligned + size > this->capacity){
+            offset = 0;
+            needed = this->capacity - this->head + size;
+        }
+
+        if (this->capacity - this->inUse >= needed){
+            this->head = (offset + size) % this->capacity;
+            this->inUse += needed;
+            this->pending.bytes += needed;
+            return offset;
+        }
+
+        // Space held by the unsubmitted batch can only be freed by submitting it
+        if (this->inFlight.empty()){
+            this->flush();
+        }
+
+        this->stats.stalls++;
+        this->retireOldest();
+    }
+}
+
+VkCommandBuffer StagingRing::currentCommandBuffer(){
+    if (this->pending.commandBuffer != VK_NULL_HANDLE){
+        return this->pending.commandBuffer;
+    }
+
+    if (this->freeCommandBuffers.empty()){
+        VkCommandBufferAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = this->commandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(this->device, &allocateInfo, &commandBuffer) != VK_SUCCESS){
+            throw std::runtime_error("Failed to allocate staging command buffer");
+        }
+        this->freeCommandBuffers.push_back(commandBuffer);
+    }
+
+    this->pending.commandBuffer = this->freeCommandBuffers.back();
+    this->freeCommandBuffers.pop_back();
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(this->pending.commandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begin staging command buffer");
+    }
+
+    return this->pending.commandBuffer;
+}
+
+void StagingRing::retireOldest(){
+    Batch batch = this->inFlight.front();
+    this->inFlight.pop_front();
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &this->semaphore;
+    waitInfo.pValues = &batch.value;
+
+    vkWaitSemaphores(this->device, &waitInfo, UINT64_MAX);
+    vkResetCommandBuffer(batch.commandBuffer, 0);
+
+    this->freeCommandBuffers.push_back(batch.commandBuffer);
+
+    this->inUse -= batch.bytes;
+}
@@ -0,0 +1,51 @@
+#include <thread_pool.hpp>
+
+using namespace triangle;
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    this->stopping = false;
+
+    this->workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++){
+        this->workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->stopping = true;
+    }
+    this->queueCondition.notify_all();
+
+    for (auto& worker : this->workers){
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return this->workers.size();
+}
+
+void ThreadPool::workerLoop() {
+    while (true){
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(this->queueMutex);
+            this->queueCondition.wait(lock, [this](){
+                return this->stopping || !this->tasks.empty();
+            });
+
+            // Drain remaining work before exiting
+            if (this->stopping && this->tasks.empty()){
+                return;
+            }
+
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+
+        task();
+    }
+}
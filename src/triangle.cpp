@@ -1,8 +1,8 @@
 #include <map>
 #include <set>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <filesystem>
@@ -12,26 +12,50 @@
 
 using namespace triangle;
 
-VkVertexInputBindingDescription TriangleApplication::Vertex::getBindingDescription(){
+VkVertexInputBindingDescription Vertex::getBindingDescription(){
     VkVertexInputBindingDescription bindingDescription = {};
     bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(TriangleApplication::Vertex);
+    bindingDescription.stride = sizeof(Vertex);
     bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
     return bindingDescription;
 }
 
-std::array<VkVertexInputAttributeDescription, 2> TriangleApplication::Vertex::getAttributeDescriptions(){
+std::array<VkVertexInputAttributeDescription, 2> Vertex::getAttributeDescriptions(){
     std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions = {};
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
     attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(TriangleApplication::Vertex, pos);
+    attributeDescriptions[0].offset = offsetof(Vertex, pos);
 
     attributeDescriptions[1].binding = 0;
     attributeDescriptions[1].location = 1;
     attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(TriangleApplication::Vertex, color);
+    attributeDescriptions[1].offset = offsetof(Vertex, color);
+
+    return attributeDescriptions;
+}
+
+VkVertexInputBindingDescription InstanceData::getBindingDescription(){
+    VkVertexInputBindingDescription bindingDescription = {};
+    bindingDescription.binding = 1;
+    bindingDescription.stride = sizeof(InstanceData);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    return bindingDescription;
+}
+
+std::array<VkVertexInputAttributeDescription, 2> InstanceData::getAttributeDescriptions(){
+    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions = {};
+    attributeDescriptions[0].binding = 1;
+    attributeDescriptions[0].location = 2;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributeDescriptions[0].offset = offsetof(InstanceData, transform);
+
+    attributeDescriptions[1].binding = 1;
+    attributeDescriptions[1].location = 3;
+    attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributeDescriptions[1].offset = offsetof(InstanceData, color);
 
     return attributeDescriptions;
 }
@@ -41,19 +65,137 @@ TriangleApplication::TriangleApplication(
     int initialWidth,
     int initialHeight,
     int framesInFlight
-) {
-    this->maxFramesInFlight = framesInFlight;
-    this->title = title;
+) : TriangleApplication(ApplicationSettings{title, initialWidth, initialHeight, framesInFlight}) {
+}
+
+TriangleApplication::TriangleApplication(const ApplicationSettings& settings) {
+    if (settings.framesInFlight < 1){
+        throw std::invalid_argument("At least one frame must be allowed in flight");
+    }
+    this->maxFramesInFlight = settings.framesInFlight;
+    this->title = settings.title;
     
-    this->initialWindowWidth = initialWidth;
-    this->initialWindowHeight = initialHeight;
+    this->initialWindowWidth = settings.width;
+    this->initialWindowHeight = settings.height;
+    this->offscreenExtent = {static_cast<uint32_t>(settings.width), static_cast<uint32_t>(settings.height)};
 
-    this->deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    this->headless = settings.headless;
+    this->frameLimit = settings.frameLimit;
+    this->frameCount = 0;
+
+    this->verbose = settings.verbose;
+
+    this->pacingProfile = settings.pacingProfile;
+    this->presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    this->presentWaitEnabled = false;
+    this->waitForPresent = nullptr;
+    this->lastPresentId = 0;
+    this->frameStartTimes.resize(this->maxFramesInFlight);
+
+    if (settings.targetFrameRate < 0.0){
+        throw std::invalid_argument("The target frame rate cannot be negative");
+    }
+    this->targetFrameRate = settings.targetFrameRate;
+    this->adaptiveFrameSleep = settings.adaptiveFrameSleep;
+    this->refreshIntervalMs = 0.0;
+    this->gpuFrameEstimateMs = 0.0;
+    this->limiterWaitMs = 0.0;
+
+    this->recordingThreads = settings.recordingThreads;
+
+    this->gpuCulling = settings.gpuCulling;
+    this->asyncQueues = settings.asyncQueues;
+
+    // Narrowed to what the device supports in createLogicalDevice()
+    this->dynamicRenderingEnabled = settings.dynamicRendering;
+    this->cmdBeginRendering = nullptr;
+    this->cmdEndRendering = nullptr;
+    this->asyncCompute = false;
+    this->computeSemaphore = VK_NULL_HANDLE;
+    this->computeSubmitPending = false;
+    this->stagingWaitValue = 0;
+    this->drawIndirectCountSupported = false;
+    this->multiDrawIndirectSupported = false;
+    this->maxDrawIndirectCount = 1;
+    this->cmdDrawIndexedIndirectCount = nullptr;
+
+    this->pipelineCachePath = settings.pipelineCachePath;
+    this->pipelineCompileThreads = settings.pipelineCompileThreads;
+    this->shaderDirectory = settings.shaderDirectory;
+    this->hotReload = settings.hotReload;
+    this->shaderSourceDirectory = settings.shaderSourceDirectory;
+    this->pendingGraphicsPipeline = 0;
+    this->pendingCullPipeline = 0;
+    this->colorMode = settings.colorMode;
+
+    if (settings.uniformRingFrameSize < sizeof(FrameUniforms)){
+        throw std::invalid_argument("The uniform ring must fit at least one frame's uniforms");
+    }
+    this->uniformRingFrameSize = settings.uniformRingFrameSize;
+    this->frameUniforms = {};
+    this->frameUniformOffset = 0;
+    this->viewOffset = glm::vec2(0.0f, 0.0f);
+    this->viewZoom = 1.0f;
+    this->viewRotation = 0.0f;
+    this->graphicsVariantsBuilt = 0;
+    this->graphicsPipeline = 0;
+    this->cullPipeline = 0;
+    this->activeGraphicsPipeline = VK_NULL_HANDLE;
+    this->activeCullPipeline = VK_NULL_HANDLE;
+    this->firstDrawRecorded = false;
+
+    this->timestampQueryPool = VK_NULL_HANDLE;
+    this->gpuTimestampsSupported = false;
+    this->lastGpuRenderPassMs = -1.0;
+    this->gpuTimingLogInterval = settings.gpuTimingLogInterval;
+    this->gpuTimingSampleCount = 0;
+    this->gpuTimingSum = 0.0;
+    this->gpuTimingMin = 0.0;
+    this->gpuTimingMax = 0.0;
+
+    if (settings.stagingBufferSize == 0){
+        throw std::invalid_argument("The staging buffer must not be empty");
+    }
+    this->stagingBufferSize = settings.stagingBufferSize;
+
+    this->window = nullptr;
+    this->surface = VK_NULL_HANDLE;
+
+    // Offscreen rendering never presents, so the swapchain extension is optional
+    if (!this->headless){
+        this->deviceExtensions = {
+            VK_KHR_SWAPCHAIN_EXTENSION_NAME
+        };
+    }
 
     this->currentFrame = 0;
 
+    if (settings.meshPath.empty()){
+        this->mesh.vertices = {
+            {{0.0f, -0.5f}, {1.0f, 1.0f, 1.0f}},
+            {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
+            {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
+        };
+        this->mesh.indices = {0, 1, 2};
+    }
+    else {
+        this->mesh = Mesh::load(settings.meshPath);
+        if (settings.optimizeMesh){
+            optimizeVertexCache(this->mesh.indices, this->mesh.vertices.size());
+        }
+    }
+
+    // A single untransformed, untinted instance
+    this->instances = {
+        {{0.0f, 0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}}
+    };
+    this->instanceBuffer = VK_NULL_HANDLE;
+    this->graphicsVariant = this->selectGraphicsVariant();
+
+    this->drawList = {
+        {static_cast<uint32_t>(this->mesh.indices.size()), 1, 0, 0, 0}
+    };
+
     this->validationLayers = {
         VK_STD_VALIDATION_LAYERS
     };
@@ -66,14 +208,172 @@ TriangleApplication::TriangleApplication(
 }
 
 void TriangleApplication::run() {
-    initWindow();
+    if (!this->headless){
+        initWindow();
+    }
     initVulkan();
     mainLoop();
     cleanUp();
 }
 
+void TriangleApplication::benchmark(uint32_t warmupFrames, uint32_t measuredFrames, FrameStats& stats) {
+    if (!this->headless){
+        initWindow();
+    }
+    initVulkan();
+    benchmarkLoop(warmupFrames, measuredFrames, stats);
+    cleanUp();
+}
+
+const FrameTimings& TriangleApplication::getLastFrameTimings() const {
+    return this->lastFrameTimings;
+}
+
+const std::string& TriangleApplication::getDeviceName() const {
+    return this->deviceName;
+}
+
+void TriangleApplication::setDrawList(std::vector<DrawCommand> drawList) {
+    this->drawList = std::move(drawList);
+}
+
+const std::vector<DrawCommand>& TriangleApplication::getDrawList() const {
+    return this->drawList;
+}
+
+void TriangleApplication::setFrameCallback(FrameCallback callback) {
+    this->frameCallback = std::move(callback);
+}
+
+double TriangleApplication::getLastGpuRenderPassMs() const {
+    return this->lastGpuRenderPassMs;
+}
+
+MemoryAllocator::Stats TriangleApplication::getMemoryStats() const {
+    return this->memoryAllocator->getStats();
+}
+
+const Mesh& TriangleApplication::getMesh() const {
+    return this->mesh;
+}
+
+VkPresentModeKHR TriangleApplication::getPresentMode() const {
+    return this->presentMode;
+}
+
+uint32_t TriangleApplication::getSwapChainImageCount() const {
+    return static_cast<uint32_t>(this->swapChainImages.size());
+}
+
+double TriangleApplication::getFrameInterval() const {
+    return this->frameLimiter.getInterval();
+}
+
+FrameLimiter::Stats TriangleApplication::getFrameLimiterStats() const {
+    return this->frameLimiter.getStats();
+}
+
+bool TriangleApplication::hasPresentWait() const {
+    return this->presentWaitEnabled;
+}
+
+bool TriangleApplication::hasDynamicRendering() const {
+    return this->dynamicRenderingEnabled;
+}
+
+RenderTargetStats TriangleApplication::getRenderTargetStats() const {
+    return this->renderTargetStats;
+}
+
+void TriangleApplication::resize(uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0){
+        throw std::invalid_argument("Render targets cannot be resized to zero");
+    }
+
+    if (this->headless){
+        this->offscreenExtent = {width, height};
+    }
+    else {
+        glfwSetWindowSize(this->window, static_cast<int>(width), static_cast<int>(height));
+    }
+    this->framebufferResized = true;
+}
+
+bool TriangleApplication::hasGpuCulling() const {
+    return this->gpuCulling;
+}
+
+bool TriangleApplication::hasAsyncCompute() const {
+    return this->asyncCompute;
+}
+
+bool TriangleApplication::hasAsyncTransfer() const {
+    return this->transferQueueFamily != this->graphicsQueueFamily;
+}
+
+DescriptorAllocator& TriangleApplication::getDescriptorAllocator() {
+    return *this->descriptorAllocator;
+}
+
+DescriptorLayoutCache& TriangleApplication::getDescriptorLayoutCache() {
+    return *this->descriptorLayoutCache;
+}
+
+const StartupTimings& TriangleApplication::getStartupTimings() const {
+    return this->startupTimings;
+}
+
+void TriangleApplication::setInstances(std::vector<InstanceData> instances){
+    if (instances.empty()){
+        throw std::invalid_argument("At least one instance is required");
+    }
+    this->instances = std::move(instances);
+    this->graphicsVariant = this->selectGraphicsVariant();
+
+    // Before initialization the buffer is simply created from the new data
+    if (this->instanceBuffer == VK_NULL_HANDLE){
+        return;
+    }
+
+    // The old buffer's release may not have been acquired by a frame yet
+    vkDeviceWaitIdle(this->device);
+    this->stagingRing->forget(this->instanceBuffer);
+    this->memoryAllocator->destroyBuffer(this->instanceBuffer, this->instanceBufferAllocation);
+    this->createInstanceBuffer();
+
+    // The culling outputs are sized per instance
+    if (this->gpuCulling){
+        this->destroyDrawBuffers();
+        this->createDrawBuffers();
+    }
+}
+
+const std::vector<InstanceData>& TriangleApplication::getInstances() const {
+    return this->instances;
+}
+
+void TriangleApplication::setView(glm::vec2 offset, float zoom, float rotation){
+    this->viewOffset = offset;
+    this->viewZoom = zoom;
+    this->viewRotation = rotation;
+}
+
+void TriangleApplication::setColorMode(ColorMode mode){
+    this->colorMode = mode;
+    this->graphicsVariant = this->selectGraphicsVariant();
+}
+
+ColorMode TriangleApplication::getColorMode() const {
+    return this->colorMode;
+}
+
+uint64_t TriangleApplication::getPipelineVariantCount() const {
+    return this->graphicsVariantsBuilt;
+}
+
 void TriangleApplication::initVulkan() {
     // Enter initialization code here
+    this->initStart = FrameClock::now();
 
     // Create a vulkan instance
     createVkInstance();
@@ -82,7 +382,9 @@ void TriangleApplication::initVulkan() {
     setupDebugMessenger();
 
     // Create the Vulkan Surface
-    createSurface();
+    if (!this->headless){
+        createSurface();
+    }
 
     // Select the physical Device
     pickPhysicalDevice();
@@ -90,8 +392,28 @@ void TriangleApplication::initVulkan() {
     // Create a logical device based on the physical devices
     createLogicalDevice();
 
-    // Create the display swapchain
-    createSwapChain();
+    // Create the device memory sub-allocator
+    this->memoryAllocator = std::make_unique<MemoryAllocator>(this->physicalDevice, this->device);
+
+    // Create the descriptor set layout cache and the per-frame descriptor allocator
+    this->descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(this->device);
+    this->descriptorAllocator = std::make_unique<DescriptorAllocator>(this->device, *this->descriptorLayoutCache, static_cast<uint32_t>(this->maxFramesInFlight));
+
+    // Load the pipeline cache left by the previous run
+    this->pipelineCache = std::make_unique<PipelineCache>(this->physicalDevice, this->device, this->pipelineCachePath);
+
+    this->shaderLibrary = std::make_unique<ShaderLibrary>(this->shaderDirectory);
+
+    // Compile pipelines in the background so the first frames are not blocked on them
+    this->pipelineManager = std::make_unique<PipelineManager>(this->device, this->pipelineCache->get(), this->pipelineCompileThreads);
+
+    // Create the display swapchain, or the offscreen targets that replace it
+    if (this->headless){
+        createOffscreenImages();
+    }
+    else {
+        createSwapChain();
+    }
 
     // Create the swapchain image views
     createImageViews();
@@ -99,6 +421,9 @@ void TriangleApplication::initVulkan() {
     // Create the render pass
     createRenderPass();
 
+    // Create the per-frame uniform ring and the descriptor set that reads it
+    createFrameUniforms();
+
     // Create the graphics pipeline
     createGraphicsPipeline();
 
@@ -108,87 +433,271 @@ void TriangleApplication::initVulkan() {
     // Create the drawing command pool
     createCommandPool();
 
+    // Create the GPU timestamp queries
+    createQueryPool();
+
+    // Create the upload ring for device-local buffers
+    createStagingRing();
+
     // Create the vertex buffers
     createVertexBuffers();
 
+    // Create the index buffer
+    createIndexBuffer();
+
+    // Create the per-instance attribute buffer
+    createInstanceBuffer();
+
+    // Create the compute culling pipeline and its indirect draw buffers
+    if (this->gpuCulling){
+        createCullingPipeline();
+        createDrawBuffers();
+    }
+
     // Create the command buffers
     createCommandBuffers();
 
     // Create the render semaphores
     createSyncObjects();
+
+    // Watch shaders for edits
+    if (this->hotReload){
+        createShaderWatcher();
+    }
+
+    this->startupTimings.initMs = elapsedMilliseconds(this->initStart);
+    this->startupTimings.pipelineCacheWarm = this->pipelineCache->isWarm();
+    this->startupTimings.shadersEmbedded = this->shaderLibrary->getSource() == ShaderLibrary::Source::Embedded;
 }
 
 void TriangleApplication::drawFrame(){
-    vkWaitForFences(this->device, 1, &this->inFlightFences[this->currentFrame], VK_TRUE, UINT64_MAX);
+    auto frameStart = FrameClock::now();
+    this->lastFrameTimings = {};
+    this->lastFrameTimings.limiterWaitMs = this->limiterWaitMs;
+
+    // A single timeline wait for the submission that last used this frame slot
+    bool slotUsed = this->frameScheduler->getFrameValue() > static_cast<uint64_t>(this->maxFramesInFlight);
+    this->currentFrame = this->frameScheduler->beginFrame();
+    this->lastFrameTimings.fenceWaitMs = elapsedMilliseconds(frameStart);
+
+    // Without present wait, the slot's previous frame finishing rendering is the closest
+    // observable point to its present
+    if(!this->presentWaitEnabled && slotUsed){
+        this->lastFrameTimings.latencyMs = elapsedMilliseconds(this->frameStartTimes[this->currentFrame]);
+    }
+
+    // The last submission from this frame slot has finished, so its timestamps can be read
+    if (this->collectGpuTimings(this->currentFrame) && this->adaptiveFrameSleep){
+        this->gpuFrameEstimateMs = this->gpuFrameEstimateMs > 0.0 ?
+            this->gpuFrameEstimateMs * 0.9 + this->lastGpuRenderPassMs * 0.1 : this->lastGpuRenderPassMs;
+    }
+
+    // Release staging regions whose uploads have completed
+    this->stagingRing->reclaim();
+
+    // Recycle the descriptor pools this frame slot allocated from last time
+    this->descriptorAllocator->beginFrame(static_cast<uint32_t>(this->currentFrame));
+
+    // Destroy pipelines and swapchains no completed frame still uses. Pipelines go first, as
+    // one may still be compiling against a retired render pass.
+    uint64_t completedValue = this->frameScheduler->getCompletedValue();
+    this->releaseRetiredPipelines(completedValue);
+    this->releaseRetiredSwapChains(completedValue);
+
+    // Start rebuilding pipelines whose shaders were edited
+    this->reloadChangedShaders();
 
     uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(
-        this->device, 
-        this->swapChain, 
-        UINT64_MAX, 
-        this->imageAvailableSemaphores[this->currentFrame], 
-        VK_NULL_HANDLE, &imageIndex
-    );
+    VkResult result = VK_SUCCESS;
 
-    if(result == VK_ERROR_OUT_OF_DATE_KHR){
-        this->recreateSwapChain();
-        return;
+    if(this->headless){
+        // Offscreen images are owned one per frame in flight
+        imageIndex = static_cast<uint32_t>(this->currentFrame);
+    }
+    else {
+        auto acquireStart = FrameClock::now();
+        result = vkAcquireNextImageKHR(
+            this->device, 
+            this->swapChain, 
+            UINT64_MAX, 
+            this->imageAvailableSemaphores[this->currentFrame], 
+            VK_NULL_HANDLE, &imageIndex
+        );
+        this->lastFrameTimings.acquireWaitMs = elapsedMilliseconds(acquireStart);
+
+        if(result == VK_ERROR_OUT_OF_DATE_KHR){
+            this->recreateSwapChain();
+            return;
+        }
+        else if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR){
+            throw std::runtime_error("Failed to acquire the swapchain!");
+        }
     }
-    else if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR){
-        throw std::runtime_error("Failed to acquire the swapchain!");
+
+    // No per-image wait: an image is only acquired again once its last present has finished,
+    // and that present waited for the frame which rendered it
+
+    if(this->frameCallback){
+        this->frameCallback(*this, this->frameCount);
     }
 
-    if(this->imagesInFlight[imageIndex] != VK_NULL_HANDLE){
-        vkWaitForFences(this->device, 1, &this->imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+    // The slot's previous submission has finished, so its uniform region can be rewritten
+    this->updateFrameUniforms(this->currentFrame);
+
+    auto recordStart = FrameClock::now();
+    this->recordCommandBuffer(this->currentFrame, imageIndex);
+    this->lastFrameTimings.recordMs = elapsedMilliseconds(recordStart);
+
+    if(!this->firstDrawRecorded && this->activeGraphicsPipeline != VK_NULL_HANDLE){
+        this->firstDrawRecorded = true;
+        this->startupTimings.firstDrawMs = elapsedMilliseconds(this->initStart);
+        this->startupTimings.pipelineMs = this->pipelineManager->getStats().compileMs;
+        this->startupTimings.shaderLoadMs = this->shaderLibrary->getStats().loadMs;
+
+        if(this->verbose){
+            std::cout << "Startup: " << this->startupTimings.initMs << " ms to initialize, " <<
+                this->startupTimings.firstDrawMs << " ms to the first draw, " <<
+                this->startupTimings.pipelineMs << " ms compiling pipelines with a " <<
+                (this->startupTimings.pipelineCacheWarm ? "warm" : "cold") << " pipeline cache, " <<
+                this->startupTimings.shaderLoadMs << " ms loading shaders from " <<
+                (this->startupTimings.shadersEmbedded ? "the executable" : this->shaderLibrary->getDirectory()) << std::endl;
+        }
     }
-    this->imagesInFlight[imageIndex] = this->inFlightFences[currentFrame];
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = {this->imageAvailableSemaphores[this->currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    // Wait for the swapchain image, uploads from the transfer queue and culling on the
+    // compute queue. Values for binary semaphores are ignored.
+    std::array<VkSemaphore, 3> waitSemaphores;
+    std::array<uint64_t, 3> waitValues;
+    std::array<VkPipelineStageFlags, 3> waitStages;
+    uint32_t waitCount = 0;
+
+    if(!this->headless){
+        waitSemaphores[waitCount] = this->imageAvailableSemaphores[this->currentFrame];
+        waitValues[waitCount] = 0;
+        waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        waitCount++;
+    }
+    if(this->stagingWaitValue > 0){
+        waitSemaphores[waitCount] = this->stagingRing->getSemaphore();
+        waitValues[waitCount] = this->stagingWaitValue;
+        waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        waitCount++;
+    }
+    if(this->computeSubmitPending){
+        this->submitCompute(this->currentFrame);
+
+        waitSemaphores[waitCount] = this->computeSemaphore;
+        waitValues[waitCount] = this->frameScheduler->getFrameValue();
+        waitStages[waitCount] = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+        waitCount++;
+    }
+
+    submitInfo.waitSemaphoreCount = waitCount;
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
 
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+    submitInfo.pCommandBuffers = &this->frameCommandBuffers[this->currentFrame];
 
-    VkSemaphore signalSemaphores[] = {this->renderFinishedSemaphores[this->currentFrame]};
+    // The timeline value marks the frame complete; the binary semaphore gates the present
+    VkSemaphore signalSemaphores[] = {this->frameScheduler->getSemaphore(), VK_NULL_HANDLE};
+    uint64_t signalValues[] = {this->frameScheduler->getFrameValue(), 0};
     submitInfo.signalSemaphoreCount = 1;
+    if(!this->headless){
+        signalSemaphores[1] = this->renderFinishedSemaphores[imageIndex];
+        submitInfo.signalSemaphoreCount = 2;
+    }
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    vkResetFences(this->device, 1, &this->inFlightFences[this->currentFrame]);
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+    submitInfo.pNext = &timelineInfo;
 
-    if(vkQueueSubmit(this->graphicsQueue, 1, &submitInfo, this->inFlightFences[this->currentFrame]) != VK_SUCCESS){
+    if(vkQueueSubmit(this->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS){
         throw std::runtime_error("Failed to submit queue!");
     }
+    uint64_t frameValue = this->frameScheduler->getFrameValue();
+    this->frameScheduler->endFrame();
+    this->frameStartTimes[this->currentFrame] = frameStart;
+
+    if(this->gpuTimestampsSupported){
+        this->timestampQueriesPending[this->currentFrame] = true;
+    }
 
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    // Offscreen frames are complete once submitted
+    if(!this->headless){
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &this->renderFinishedSemaphores[imageIndex];
+
+        VkSwapchainKHR swapChains[] = {this->swapChain};
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = nullptr;
+
+        VkPresentIdKHR presentId = {};
+        presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentId.swapchainCount = 1;
+        presentId.pPresentIds = &frameValue;
+        if(this->presentWaitEnabled){
+            presentInfo.pNext = &presentId;
+        }
 
-    VkSwapchainKHR swapChains[] = {this->swapChain};
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
-    presentInfo.pResults = nullptr;
+        auto presentStart = FrameClock::now();
+        result = vkQueuePresentKHR(this->presentQueue, &presentInfo);
+        this->lastFrameTimings.presentMs = elapsedMilliseconds(presentStart);
 
-    result = vkQueuePresentKHR(this->presentQueue, &presentInfo);
+        if(this->presentWaitEnabled && (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)){
+            this->waitForPreviousPresent();
+            this->lastPresentId = frameValue;
+            this->lastPresentStart = frameStart;
+        }
 
-    if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || this->framebufferResized){
+        if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || this->framebufferResized){
+            this->framebufferResized = false;
+            this->recreateSwapChain();
+        }
+        else if (result != VK_SUCCESS){
+            throw std::runtime_error("Failed to present swap chain image");
+        }
+    }
+    else if(this->framebufferResized){
         this->framebufferResized = false;
         this->recreateSwapChain();
     }
-    else if (result != VK_SUCCESS){
-        throw std::runtime_error("Failed to present swap chain image");
+
+    // No queue idle here: the timeline wait in beginFrame() alone bounds how far the CPU runs ahead
+    this->frameCount++;
+
+    this->lastFrameTimings.cpuFrameMs = elapsedMilliseconds(frameStart);
+}
+
+void TriangleApplication::waitForPreviousPresent(){
+    if(this->lastPresentId == 0){
+        return;
     }
-    
-    vkQueueWaitIdle(this->presentQueue);
 
-    this->currentFrame = (this->currentFrame + 1) % this->maxFramesInFlight;
+    // Bounded, as a hidden or minimized window may never display the frame
+    const uint64_t timeoutNs = 100000000;
+
+    // Leaves only the frame just presented queued; the loop polls input right after this
+    auto waitStart = FrameClock::now();
+    VkResult result = this->waitForPresent(this->device, this->swapChain, this->lastPresentId, timeoutNs);
+    this->lastFrameTimings.presentWaitMs = elapsedMilliseconds(waitStart);
+
+    // Timeouts and out-of-date swapchains just skip the measurement
+    if(result == VK_SUCCESS){
+        this->lastFrameTimings.latencyMs = elapsedMilliseconds(this->lastPresentStart);
+    }
 }
 
 void TriangleApplication::createVkInstance() {
@@ -199,13 +708,15 @@ void TriangleApplication::createVkInstance() {
     std::vector<VkExtensionProperties> availableExtensions(vkInstanceExtensionCount);
     vkEnumerateInstanceExtensionProperties(nullptr, &vkInstanceExtensionCount, availableExtensions.data());
 
-    std::cout << "Available extensions:" << std::endl;
+    if (this->verbose){
+        std::cout << "Available extensions:" << std::endl;
 
-    for (const auto& extension : availableExtensions) {
-        std::cout << "\t" << extension.extensionName << std::endl;
-    }
+        for (const auto& extension : availableExtensions) {
+            std::cout << "\t" << extension.extensionName << std::endl;
+        }
 
-    std::cout.flush();
+        std::cout.flush();
+    }
 
     // Check for validation layer support
     if (this->validationLayersEnabled && !checkValidationLayerSupport()){
@@ -219,7 +730,8 @@ void TriangleApplication::createVkInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_1;
+    // 1.2 for timeline semaphores
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     // Create the information struct
     VkInstanceCreateInfo createInfo = {};
@@ -271,6 +783,47 @@ void TriangleApplication::initWindow() {
     );
     glfwSetWindowUserPointer(this->window, this);
     glfwSetFramebufferSizeCallback(this->window, this->framebufferResizedCallback);
+    glfwSetWindowPosCallback(this->window, this->windowMovedCallback);
+
+    this->updateRefreshInterval();
+}
+
+void TriangleApplication::updateRefreshInterval(){
+    // Frames beyond the refresh rate are never displayed, so adaptive pacing stops there
+    GLFWmonitor* monitor = glfwGetWindowMonitor(this->window);
+
+    // A windowed window is on whichever monitor's work area it overlaps most
+    if (monitor == nullptr){
+        int windowX, windowY, windowWidth, windowHeight;
+        glfwGetWindowPos(this->window, &windowX, &windowY);
+        glfwGetWindowSize(this->window, &windowWidth, &windowHeight);
+
+        int monitorCount = 0;
+        GLFWmonitor** monitors = glfwGetMonitors(&monitorCount);
+
+        long long bestOverlap = 0;
+        for (int i = 0; i < monitorCount; i++){
+            int areaX, areaY, areaWidth, areaHeight;
+            glfwGetMonitorWorkarea(monitors[i], &areaX, &areaY, &areaWidth, &areaHeight);
+
+            long long overlapWidth = std::min(windowX + windowWidth, areaX + areaWidth) - std::max(windowX, areaX);
+            long long overlapHeight = std::min(windowY + windowHeight, areaY + areaHeight) - std::max(windowY, areaY);
+            if (overlapWidth > 0 && overlapHeight > 0 && overlapWidth * overlapHeight > bestOverlap){
+                bestOverlap = overlapWidth * overlapHeight;
+                monitor = monitors[i];
+            }
+        }
+    }
+
+    // Some platforms (Wayland) do not report window positions
+    if (monitor == nullptr){
+        monitor = glfwGetPrimaryMonitor();
+    }
+
+    const GLFWvidmode* mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+    if (mode != nullptr && mode->refreshRate > 0){
+        this->refreshIntervalMs = 1000.0 / mode->refreshRate;
+    }
 }
 
 void TriangleApplication::framebufferResizedCallback(GLFWwindow* window, int width, int height){
@@ -278,11 +831,82 @@ void TriangleApplication::framebufferResizedCallback(GLFWwindow* window, int wid
     app->framebufferResized = true;
 }
 
+void TriangleApplication::windowMovedCallback(GLFWwindow* window, int x, int y){
+    auto app = reinterpret_cast<TriangleApplication*>(glfwGetWindowUserPointer(window));
+    app->updateRefreshInterval();
+}
+
+void TriangleApplication::paceFrame(){
+    double intervalMs = this->targetFrameRate > 0.0 ? 1000.0 / this->targetFrameRate : 0.0;
+
+    if (this->adaptiveFrameSleep){
+        // FIFO already blocks at the refresh rate in acquire/present
+        double refreshMs = this->presentMode == VK_PRESENT_MODE_FIFO_KHR ? 0.0 : this->refreshIntervalMs;
+        // Starting frames faster than the GPU finishes them only queues them up; stay slightly
+        // ahead of its measured time so it never waits on the CPU. The render pass time
+        // excludes culling, so any shortfall is still absorbed by the timeline wait.
+        double gpuMs = this->gpuFrameEstimateMs * 0.95;
+        intervalMs = std::max({intervalMs, refreshMs, gpuMs});
+    }
+
+    this->frameLimiter.setInterval(intervalMs);
+    this->limiterWaitMs = this->frameLimiter.wait();
+}
+
 void TriangleApplication::mainLoop() {
     // Enter main loop code here
+    if (this->headless){
+        auto start = FrameClock::now();
+
+        while (this->frameLimit == 0 || this->frameCount < this->frameLimit){
+            paceFrame();
+            drawFrame();
+        }
+
+        vkDeviceWaitIdle(this->device);
+
+        double elapsedSeconds = elapsedMilliseconds(start) / 1000.0;
+        std::cout << "Rendered " << this->frameCount << " frames in " << elapsedSeconds << " s (" <<
+            this->frameCount / elapsedSeconds << " fps)" << std::endl;
+        return;
+    }
+
     while (!glfwWindowShouldClose(this->window)){
+        // Sleep before polling so the frame is built from the freshest input
+        paceFrame();
         glfwPollEvents();
         drawFrame();
+
+        if (this->frameLimit != 0 && this->frameCount >= this->frameLimit){
+            break;
+        }
+    }
+
+    vkDeviceWaitIdle(this->device);
+}
+
+void TriangleApplication::benchmarkLoop(uint32_t warmupFrames, uint32_t measuredFrames, FrameStats& stats) {
+    stats.clear();
+
+    // Measure steady-state frames, not ones that skip drawing while pipelines compile
+    this->pipelineManager->waitIdle();
+
+    uint64_t targetFrames = static_cast<uint64_t>(warmupFrames) + measuredFrames;
+    while (this->frameCount < targetFrames){
+        paceFrame();
+
+        if (!this->headless){
+            if (glfwWindowShouldClose(this->window)) break;
+            glfwPollEvents();
+        }
+
+        // Frames dropped for swapchain recreation are neither counted nor measured
+        uint64_t framesBefore = this->frameCount;
+        drawFrame();
+
+        if (this->frameCount > framesBefore && framesBefore >= warmupFrames){
+            stats.record(this->lastFrameTimings);
+        }
     }
 
     vkDeviceWaitIdle(this->device);
@@ -291,28 +915,109 @@ void TriangleApplication::mainLoop() {
 void TriangleApplication::cleanUp() {
     // Enter clean up code here
 
-    // Clean up the swapchain
+    // Finish uploads still being batched while their destination buffers exist
+    if (this->stagingRing){
+        this->stagingRing->flush();
+        this->stagingRing->waitIdle();
+    }
+
+    // Finish shader reloads before the layouts and render pass they build against go away
+    this->shaderWatcher.reset();
+    if (this->pendingGraphicsPipeline != 0){
+        this->pipelineManager->destroy(this->pendingGraphicsPipeline);
+    }
+    if (this->pendingCullPipeline != 0){
+        this->pipelineManager->destroy(this->pendingCullPipeline);
+    }
+    this->pipelineManager->waitIdle();
+    this->releaseRetiredPipelines(UINT64_MAX);
+
+    // Clean up the swapchain, including any still waiting for deferred destruction
+    this->releaseRetiredSwapChains(UINT64_MAX);
     this->cleanUpSwapChain();
 
-    // Remove the vertex buffer
-    vkDestroyBuffer(this->device, this->vertexBuffer, nullptr);
-    vkFreeMemory(this->device, this->vertexBufferMemory, nullptr);
+    // Clean up the render pass and graphics pipeline
+    this->cleanUpGraphicsPipeline();
+
+    // Remove the vertex and index buffers
+    this->memoryAllocator->destroyBuffer(this->vertexBuffer, this->vertexBufferAllocation);
+    this->memoryAllocator->destroyBuffer(this->indexBuffer, this->indexBufferAllocation);
+    this->memoryAllocator->destroyBuffer(this->instanceBuffer, this->instanceBufferAllocation);
+
+    // Remove the culling pipeline and indirect draw buffers
+    if (this->gpuCulling){
+        this->destroyDrawBuffers();
+        this->pipelineManager->destroy(this->cullPipeline);
+        vkDestroyPipelineLayout(this->device, this->cullPipelineLayout, nullptr);
+    }
+
+    // Remove the per-frame uniforms
+    this->destroyFrameUniforms();
+
+    // Stop the compile workers, then persist the pipeline cache for the next launch.
+    // Failing to save it is not fatal.
+    this->pipelineManager.reset();
+    this->shaderLibrary.reset();
+    try {
+        this->pipelineCache->save();
+    }
+    catch (std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+    }
+    this->pipelineCache.reset();
+
+    // Remove the descriptor pools and set layouts
+    this->descriptorAllocator.reset();
+    this->descriptorLayoutCache.reset();
+
+    // Remove the staging ring once its uploads have retired
+    this->stagingRing.reset();
+    this->memoryAllocator->destroyBuffer(this->stagingBuffer, this->stagingBufferAllocation);
 
     // Clean up the semaphores
-    for(size_t i = 0; i < this->maxFramesInFlight; i++){
-        vkDestroySemaphore(this->device, this->imageAvailableSemaphores[i], nullptr);
-        vkDestroySemaphore(this->device, this->renderFinishedSemaphores[i], nullptr);
-        vkDestroyFence(this->device, this->inFlightFences[i], nullptr);
+    for(VkSemaphore semaphore : this->imageAvailableSemaphores){
+        vkDestroySemaphore(this->device, semaphore, nullptr);
+    }
+    for(VkSemaphore semaphore : this->renderFinishedSemaphores){
+        vkDestroySemaphore(this->device, semaphore, nullptr);
     }
+    if(this->computeSemaphore != VK_NULL_HANDLE){
+        vkDestroySemaphore(this->device, this->computeSemaphore, nullptr);
+    }
+    this->frameScheduler.reset();
+
+    // Clean up the timestamp queries
+    if (this->timestampQueryPool != VK_NULL_HANDLE){
+        vkDestroyQueryPool(this->device, this->timestampQueryPool, nullptr);
+    }
+
+    // Stop the recording threads before their pools go away
+    this->recordingPool.reset();
 
-    // Clean up the command pool
+    // Clean up the command pools, which frees their command buffers
+    for(size_t i = 0; i < this->secondaryCommandPools.size(); i++){
+        for(size_t j = 0; j < this->secondaryCommandPools[i].size(); j++){
+            vkDestroyCommandPool(this->device, this->secondaryCommandPools[i][j], nullptr);
+        }
+    }
+    for(size_t i = 0; i < this->frameCommandPools.size(); i++){
+        vkDestroyCommandPool(this->device, this->frameCommandPools[i], nullptr);
+    }
+    for(size_t i = 0; i < this->computeCommandPools.size(); i++){
+        vkDestroyCommandPool(this->device, this->computeCommandPools[i], nullptr);
+    }
     vkDestroyCommandPool(this->device, this->commandPool, nullptr);
 
+    // Release the memory blocks once every resource in them is gone
+    this->memoryAllocator.reset();
+
     // Clean up the logical device
     vkDestroyDevice(this->device, nullptr);
     
     // Clean up the surface instance
-    vkDestroySurfaceKHR(this->vkInstance, this->surface, nullptr);
+    if (!this->headless){
+        vkDestroySurfaceKHR(this->vkInstance, this->surface, nullptr);
+    }
 
     // Clean up debug messenger
     if (this->validationLayersEnabled){
@@ -320,9 +1025,11 @@ void TriangleApplication::cleanUp() {
     }
     vkDestroyInstance(this->vkInstance, nullptr);
 
-    glfwDestroyWindow(this->window);
+    if (!this->headless){
+        glfwDestroyWindow(this->window);
 
-    glfwTerminate();
+        glfwTerminate();
+    }
 }
 
 bool TriangleApplication::checkValidationLayerSupport(){
@@ -351,11 +1058,16 @@ bool TriangleApplication::checkValidationLayerSupport(){
 }
 
 std::vector<const char*> TriangleApplication::getRequiredExtensions() {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
+    std::vector<const char*> extensions;
+
+    // Surface extensions are only needed when presenting to a window
+    if (!this->headless){
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
 
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (this->validationLayersEnabled){
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -415,6 +1127,10 @@ void TriangleApplication::pickPhysicalDevice(){
 
     if (candidates.rbegin()->first > 0){
         this->physicalDevice = candidates.rbegin()->second;
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(this->physicalDevice, &deviceProperties);
+        this->deviceName = deviceProperties.deviceName;
     }
     else {
         throw std::runtime_error("Failed to find suitable GPU.");
@@ -444,6 +1160,22 @@ bool TriangleApplication::checkDeviceExtensionSupport(const VkPhysicalDevice dev
     return requiredExtensions.empty();
 }
 
+bool TriangleApplication::checkOptionalDeviceExtension(const VkPhysicalDevice device, const char* extensionName){
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions) {
+        if (strcmp(extension.extensionName, extensionName) == 0){
+            return true;
+        }
+    }
+
+    return false;
+}
+
 unsigned int TriangleApplication::rateDeviceSuitability(const VkPhysicalDevice device){
     VkPhysicalDeviceProperties deviceProperties;
     VkPhysicalDeviceFeatures deviceFeatures;
@@ -456,8 +1188,8 @@ unsigned int TriangleApplication::rateDeviceSuitability(const VkPhysicalDevice d
     QueueFamilyIndicies indicies = findQueueFamilies(device);
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    bool swapChainAdequate = this->headless;
+    if (extensionsSupported && !this->headless) {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
         swapChainAdequate = 
             !swapChainSupport.formats.empty() &&
@@ -469,13 +1201,35 @@ unsigned int TriangleApplication::rateDeviceSuitability(const VkPhysicalDevice d
         !swapChainAdequate) 
         return 0;
 
-    if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-        score += 1000;
+    // Frames are paced with a timeline semaphore
+    if (deviceProperties.apiVersion < VK_API_VERSION_1_2)
+        return 0;
+
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &timelineFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+
+    if (!timelineFeatures.timelineSemaphore)
+        return 0;
+
+    // GPU culling selects each instance through firstInstance; prefer devices that can run it
+    // over falling back to drawing every instance
+    if (this->gpuCulling && deviceFeatures.drawIndirectFirstInstance)
+        score += 100000;
+
+    if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+        score += 1000;
     
     score += deviceProperties.limits.maxImageDimension2D;
 
-    std::cout << "Device: " << deviceProperties.deviceName << std::endl << 
-        "\tScore: " << score << std::endl;
+    if (this->verbose){
+        std::cout << "Device: " << deviceProperties.deviceName << std::endl << 
+            "\tScore: " << score << std::endl;
+    }
 
     return score;
 }
@@ -491,18 +1245,36 @@ TriangleApplication::QueueFamilyIndicies TriangleApplication::findQueueFamilies(
 
     int i = 0;
     for (const auto& queueFamily : queueFamilies){
-        if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT){
-            indicies.graphicsFamily = i;
-        }
+        if (!indicies.isComplete()){
+            if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT){
+                indicies.graphicsFamily = i;
+            }
 
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, this->surface, &presentSupport);
+            VkBool32 presentSupport = false;
+            if (this->headless){
+                // Nothing is presented, so the graphics queue doubles as the present queue
+                presentSupport = indicies.graphicsFamily.has_value() && indicies.graphicsFamily.value() == i;
+            }
+            else {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, this->surface, &presentSupport);
+            }
 
-        if (queueFamily.queueCount > 0 && presentSupport){
-            indicies.presentFamily = i;
+            if (queueFamily.queueCount > 0 && presentSupport){
+                indicies.presentFamily = i;
+            }
         }
 
-        if (indicies.isComplete()) break;
+        // Only families without graphics run on hardware separate from rendering
+        bool graphics = queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+        bool compute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
+        bool transfer = queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT;
+
+        if (queueFamily.queueCount > 0 && !graphics && compute && !indicies.computeFamily.has_value()){
+            indicies.computeFamily = i;
+        }
+        if (queueFamily.queueCount > 0 && !graphics && !compute && transfer && !indicies.transferFamily.has_value()){
+            indicies.transferFamily = i;
+        }
 
         i++;
     }
@@ -558,6 +1330,35 @@ void TriangleApplication::createLogicalDevice(){
         indicies.presentFamily.value()
     };
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(this->physicalDevice, &supportedFeatures);
+
+    // Each culled draw selects its instance through firstInstance. Decided before the queues,
+    // since only GPU culling uses the compute queue.
+    if (this->gpuCulling && !supportedFeatures.drawIndirectFirstInstance){
+        this->gpuCulling = false;
+
+        if (this->verbose){
+            std::cout << "GPU culling disabled: the device lacks drawIndirectFirstInstance, "
+                "drawing the draw list instead" << std::endl;
+        }
+    }
+
+    // Without dedicated families, compute and uploads share the graphics queue
+    this->graphicsQueueFamily = indicies.graphicsFamily.value();
+    this->computeQueueFamily = this->graphicsQueueFamily;
+    this->transferQueueFamily = this->graphicsQueueFamily;
+
+    if (this->asyncQueues && this->gpuCulling && indicies.computeFamily.has_value()){
+        this->computeQueueFamily = indicies.computeFamily.value();
+        uniqueQueueFamilies.insert(this->computeQueueFamily);
+    }
+    if (this->asyncQueues && indicies.transferFamily.has_value()){
+        this->transferQueueFamily = indicies.transferFamily.value();
+        uniqueQueueFamilies.insert(this->transferQueueFamily);
+    }
+    this->asyncCompute = this->computeQueueFamily != this->graphicsQueueFamily;
+
     float queuePriority = 1.0f;
     for (auto queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo = {};
@@ -570,6 +1371,67 @@ void TriangleApplication::createLogicalDevice(){
 
     VkPhysicalDeviceFeatures deviceFeatures = {}; // Everything is still VK_FALSE but we'll fix that later
 
+    if (this->gpuCulling){
+        deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+
+        this->multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE;
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(this->physicalDevice, &deviceProperties);
+        this->maxDrawIndirectCount = deviceProperties.limits.maxDrawIndirectCount;
+
+        // Lets the GPU decide how many of the written draws are executed
+        this->drawIndirectCountSupported = this->multiDrawIndirectSupported &&
+            checkOptionalDeviceExtension(this->physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        if (this->drawIndirectCountSupported){
+            this->deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+    }
+
+    // Lets the low latency profile start a frame only once the previous one is displayed
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+
+    if (!this->headless && this->pacingProfile == PacingProfile::LowLatency &&
+        checkOptionalDeviceExtension(this->physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        checkOptionalDeviceExtension(this->physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)){
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &presentIdFeatures;
+        vkGetPhysicalDeviceFeatures2(this->physicalDevice, &features2);
+
+        this->presentWaitEnabled = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+        if (this->presentWaitEnabled){
+            this->deviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            this->deviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+    }
+
+    // Renders into image views without render pass and framebuffer objects
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    if (this->dynamicRenderingEnabled){
+        this->dynamicRenderingEnabled = false;
+
+        if (checkOptionalDeviceExtension(this->physicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)){
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &dynamicRenderingFeatures;
+            vkGetPhysicalDeviceFeatures2(this->physicalDevice, &features2);
+
+            this->dynamicRenderingEnabled = dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+            if (this->dynamicRenderingEnabled){
+                this->deviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+            }
+        }
+    }
+
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCreateInfos.size());
@@ -577,6 +1439,22 @@ void TriangleApplication::createLogicalDevice(){
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
+    // Checked by rateDeviceSuitability()
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+    createInfo.pNext = &timelineFeatures;
+
+    // Optional features are appended after the timeline features
+    void** featureChain = &timelineFeatures.pNext;
+    if (this->presentWaitEnabled){
+        *featureChain = &presentIdFeatures;
+        featureChain = &presentWaitFeatures.pNext;
+    }
+    if (this->dynamicRenderingEnabled){
+        *featureChain = &dynamicRenderingFeatures;
+    }
+
     createInfo.enabledExtensionCount = static_cast<uint32_t>(this->deviceExtensions.size());
     createInfo.ppEnabledExtensionNames = this->deviceExtensions.data();
 
@@ -612,17 +1490,61 @@ void TriangleApplication::createLogicalDevice(){
         0,
         &this->presentQueue
     );
+
+    vkGetDeviceQueue(this->device, this->computeQueueFamily, 0, &this->computeQueue);
+    vkGetDeviceQueue(this->device, this->transferQueueFamily, 0, &this->transferQueue);
+
+    if (this->verbose && (this->asyncCompute || this->transferQueueFamily != this->graphicsQueueFamily)){
+        std::cout << "Async queues: compute on family " << this->computeQueueFamily <<
+            ", transfer on family " << this->transferQueueFamily <<
+            " (graphics on family " << this->graphicsQueueFamily << ")" << std::endl;
+    }
+
+    if (this->drawIndirectCountSupported){
+        this->cmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR) vkGetDeviceProcAddr(
+            this->device,
+            "vkCmdDrawIndexedIndirectCountKHR");
+
+        this->drawIndirectCountSupported = this->cmdDrawIndexedIndirectCount != nullptr;
+    }
+
+    if (this->presentWaitEnabled){
+        this->waitForPresent = (PFN_vkWaitForPresentKHR) vkGetDeviceProcAddr(
+            this->device,
+            "vkWaitForPresentKHR");
+
+        this->presentWaitEnabled = this->waitForPresent != nullptr;
+    }
+
+    if (this->dynamicRenderingEnabled){
+        this->cmdBeginRendering = (PFN_vkCmdBeginRenderingKHR) vkGetDeviceProcAddr(
+            this->device,
+            "vkCmdBeginRenderingKHR");
+        this->cmdEndRendering = (PFN_vkCmdEndRenderingKHR) vkGetDeviceProcAddr(
+            this->device,
+            "vkCmdEndRenderingKHR");
+
+        this->dynamicRenderingEnabled = this->cmdBeginRendering != nullptr && this->cmdEndRendering != nullptr;
+    }
+
+    if (this->verbose){
+        std::cout << "Rendering with " << (this->dynamicRenderingEnabled ? "dynamic rendering" : "a render pass") << std::endl;
+    }
 }
 
 
-void TriangleApplication::createSwapChain() {
+void TriangleApplication::createSwapChain(VkSwapchainKHR oldSwapChain) {
     SwapChainSupportDetails swapchainDetails = querySwapChainSupport(this->physicalDevice);
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapchainDetails.formats);
     VkPresentModeKHR presentMode = chooseSwapPresentMode(swapchainDetails.presentModes);
     VkExtent2D swapExtent = chooseSwapExtent(swapchainDetails.capabilities);
 
-    uint32_t imageCount = swapchainDetails.capabilities.minImageCount + 1;
+    // Every image beyond the minimum can hold another queued frame, adding a frame of latency
+    uint32_t imageCount = swapchainDetails.capabilities.minImageCount;
+    if (this->pacingProfile != PacingProfile::LowLatency){
+        imageCount++;
+    }
 
     if (swapchainDetails.capabilities.maxImageCount > 0 &&
         imageCount > swapchainDetails.capabilities.maxImageCount){
@@ -663,7 +1585,7 @@ void TriangleApplication::createSwapChain() {
     swapchainCreateInfo.presentMode = presentMode;
     swapchainCreateInfo.clipped = VK_TRUE;
 
-    swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+    swapchainCreateInfo.oldSwapchain = oldSwapChain;
 
     auto result = vkCreateSwapchainKHR(
         this->device,
@@ -682,6 +1604,43 @@ void TriangleApplication::createSwapChain() {
 
     this->swapChainImageFormat = surfaceFormat.format;
     this->swapChainImageExtent = swapExtent;
+    this->presentMode = presentMode;
+
+    // Present ids only need to increase within a swapchain
+    this->lastPresentId = 0;
+}
+
+void TriangleApplication::createOffscreenImages() {
+    // One render target per frame in flight stands in for the swapchain images
+    uint32_t imageCount = static_cast<uint32_t>(this->maxFramesInFlight);
+
+    this->swapChainImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+    this->swapChainImageExtent = this->offscreenExtent;
+
+    this->swapChainImages.resize(imageCount);
+    this->offscreenImageAllocations.resize(imageCount);
+
+    for (uint32_t i = 0; i < imageCount; i++){
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = this->swapChainImageFormat;
+        imageInfo.extent = {this->swapChainImageExtent.width, this->swapChainImageExtent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        this->memoryAllocator->createImage(
+            imageInfo,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            this->swapChainImages[i],
+            this->offscreenImageAllocations[i]
+        );
+    }
 }
 
 void TriangleApplication::cleanUpSwapChain(){
@@ -689,37 +1648,145 @@ void TriangleApplication::cleanUpSwapChain(){
         vkDestroyFramebuffer(this->device, this->swapChainFramebuffers[i], nullptr);
     }
 
-    vkFreeCommandBuffers(this->device, this->commandPool, static_cast<uint32_t>(this->commandBuffers.size()), this->commandBuffers.data());
+    for(size_t i = 0; i < this->swapChainImageViews.size(); i++){
+        vkDestroyImageView(this->device, this->swapChainImageViews[i], nullptr);
+    }
+
+    if(this->headless){
+        for(size_t i = 0; i < this->swapChainImages.size(); i++){
+            this->memoryAllocator->destroyImage(this->swapChainImages[i], this->offscreenImageAllocations[i]);
+        }
+    }
+    else {
+        vkDestroySwapchainKHR(this->device, this->swapChain, nullptr);
+    }
+}
+
+void TriangleApplication::cleanUpGraphicsPipeline(){
+    for(const auto& entry : this->graphicsVariants){
+        this->pipelineManager->destroy(entry.second);
+    }
+    this->graphicsVariants.clear();
+    this->graphicsPipeline = 0;
 
-    vkDestroyPipeline(this->device, this->graphicsPipeline, nullptr);
     vkDestroyPipelineLayout(this->device, this->pipelineLayout, nullptr);
     vkDestroyRenderPass(this->device, this->renderPass, nullptr);
+}
 
-    for(size_t i = 0; i < this->swapChainImageViews.size(); i++){
-        vkDestroyImageView(this->device, this->swapChainImageViews[i], nullptr);
-    }
+void TriangleApplication::releaseRetiredSwapChains(uint64_t completedValue){
+    while(!this->retiredSwapChains.empty() && this->retiredSwapChains.front().releaseValue <= completedValue){
+        RetiredSwapChain& retired = this->retiredSwapChains.front();
+
+        // Retired pipelines still compiling against this render pass and layout hold it back
+        if(retired.pipelineLayout != VK_NULL_HANDLE){
+            bool building = std::any_of(this->retiredPipelines.begin(), this->retiredPipelines.end(), [&](const RetiredPipeline& pipeline){
+                return pipeline.releaseValue <= retired.releaseValue;
+            });
+            if(building) break;
+        }
+
+        for(VkFramebuffer framebuffer : retired.framebuffers){
+            vkDestroyFramebuffer(this->device, framebuffer, nullptr);
+        }
+        for(VkImageView imageView : retired.imageViews){
+            vkDestroyImageView(this->device, imageView, nullptr);
+        }
+        for(VkSemaphore semaphore : retired.renderFinishedSemaphores){
+            vkDestroySemaphore(this->device, semaphore, nullptr);
+        }
+
+        if(retired.pipelineLayout != VK_NULL_HANDLE){
+            vkDestroyPipelineLayout(this->device, retired.pipelineLayout, nullptr);
+            vkDestroyRenderPass(this->device, retired.renderPass, nullptr);
+        }
 
-    vkDestroySwapchainKHR(this->device, this->swapChain, nullptr);
+        for(size_t i = 0; i < retired.offscreenImages.size(); i++){
+            this->memoryAllocator->destroyImage(retired.offscreenImages[i], retired.offscreenImageAllocations[i]);
+        }
+        if(retired.swapChain != VK_NULL_HANDLE){
+            vkDestroySwapchainKHR(this->device, retired.swapChain, nullptr);
+        }
+
+        this->retiredSwapChains.pop_front();
+    }
 }
 
 void TriangleApplication::recreateSwapChain(){
-    int width = 0, height = 0;
-    glfwGetFramebufferSize(this->window, &width, &height);
-    while(width == 0 || height == 0){
+    // A minimized window has nothing to render to until it is restored
+    if(!this->headless){
+        int width = 0, height = 0;
         glfwGetFramebufferSize(this->window, &width, &height);
-        glfwWaitEvents();
+        while(width == 0 || height == 0){
+            glfwGetFramebufferSize(this->window, &width, &height);
+            glfwWaitEvents();
+        }
     }
 
-    vkDeviceWaitIdle(this->device);
-
-    this->cleanUpSwapChain();
-    
-    this->createSwapChain();
+    auto recreateStart = FrameClock::now();
+    VkFormat previousFormat = this->swapChainImageFormat;
+
+    // Frames already submitted still reference the old objects. The timeline does not see the
+    // presentation engine, so their presents get a further cycle of frames to finish too.
+    RetiredSwapChain retired = {};
+    retired.releaseValue = this->frameScheduler->getSubmittedValue() + this->maxFramesInFlight;
+    retired.swapChain = this->headless ? VK_NULL_HANDLE : this->swapChain;
+    retired.imageViews = std::move(this->swapChainImageViews);
+    retired.framebuffers = std::move(this->swapChainFramebuffers);
+    retired.renderFinishedSemaphores = std::move(this->renderFinishedSemaphores);
+    this->swapChainImageViews.clear();
+    this->swapChainFramebuffers.clear();
+    this->renderFinishedSemaphores.clear();
+
+    if(this->headless){
+        retired.offscreenImages = std::move(this->swapChainImages);
+        retired.offscreenImageAllocations = std::move(this->offscreenImageAllocations);
+        this->swapChainImages.clear();
+        this->offscreenImageAllocations.clear();
+        this->createOffscreenImages();
+    }
+    else {
+        // Handing over the old swapchain lets presentation continue from it until the switch
+        this->createSwapChain(retired.swapChain);
+    }
     this->createImageViews();
-    this->createRenderPass();
-    this->createGraphicsPipeline();
+
+    // The render pass and pipeline only depend on the format, not the extent. Under dynamic
+    // rendering a resize only rebuilds the swapchain and its image views.
+    if(this->swapChainImageFormat != previousFormat){
+        retired.renderPass = this->renderPass;
+        retired.pipelineLayout = this->pipelineLayout;
+        this->retireGraphicsVariants();
+
+        // A reload in progress targets the old render pass or format. It is retired rather than
+        // waited for, and the old render pass is kept until it finishes; the new pipeline below
+        // already picks up the edited shaders.
+        if(this->pendingGraphicsPipeline != 0){
+            this->retirePipeline(this->pendingGraphicsPipeline);
+            this->pendingGraphicsPipeline = 0;
+        }
+
+        this->createRenderPass();
+        this->createGraphicsPipeline();
+    }
+
     this->createFrameBuffers();
-    this->createCommandBuffers();
+
+    if(!this->headless){
+        this->createRenderFinishedSemaphores();
+    }
+
+    this->retiredSwapChains.push_back(std::move(retired));
+
+    double recreateMs = elapsedMilliseconds(recreateStart);
+    this->lastFrameTimings.recreateMs = recreateMs;
+    this->renderTargetStats.recreations++;
+    this->renderTargetStats.lastRecreateMs = recreateMs;
+    this->renderTargetStats.totalRecreateMs += recreateMs;
+
+    if(this->verbose){
+        std::cout << "Recreated " << (this->headless ? "offscreen targets" : "swapchain") << " at " << this->swapChainImageExtent.width << "x" <<
+            this->swapChainImageExtent.height << " in " << recreateMs << " ms" << std::endl;
+    }
 }
 
 TriangleApplication::SwapChainSupportDetails TriangleApplication::querySwapChainSupport(const VkPhysicalDevice device){
@@ -778,9 +1845,26 @@ VkSurfaceFormatKHR TriangleApplication::chooseSwapSurfaceFormat(const std::vecto
 }
 
 VkPresentModeKHR TriangleApplication::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes){
-    for (const auto& presentMode : availablePresentModes){
-        if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR){
-            return presentMode;
+    // Modes in order of preference; FIFO is always available
+    std::vector<VkPresentModeKHR> preferredModes;
+    switch (this->pacingProfile){
+        case PacingProfile::LowLatency:
+            // A newer image replaces a queued one instead of waiting behind it, without tearing
+            preferredModes = {VK_PRESENT_MODE_MAILBOX_KHR};
+            break;
+        case PacingProfile::Smooth:
+            break;
+        case PacingProfile::Throughput:
+            // Never IMMEDIATE: this is the default profile and it must not tear
+            preferredModes = {VK_PRESENT_MODE_MAILBOX_KHR};
+            break;
+    }
+
+    for (VkPresentModeKHR preferredMode : preferredModes){
+        for (const auto& presentMode : availablePresentModes){
+            if (presentMode == preferredMode){
+                return presentMode;
+            }
         }
     }
 
@@ -852,34 +1936,15 @@ void TriangleApplication::createImageViews(){
         if (result != VK_SUCCESS) {
             throw std::runtime_error("Failed to create swapchain views");
         }
+        this->renderTargetStats.imageViews++;
     }
 }
 
-std::vector<char> TriangleApplication::readFile(const std::string& filename){
-
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open()){
-        std::stringstream ss;
-        ss << "Failed to open file: " << filename;
-        throw std::runtime_error(ss.str());
-    }
-
-    size_t fileSize = (size_t) file.tellg();
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-
-    file.close();
-    return buffer;
-}
-
-VkShaderModule TriangleApplication::createShaderModule(const std::vector<char>& code){
+VkShaderModule TriangleApplication::createShaderModule(const ShaderBlob& code){
     VkShaderModuleCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    createInfo.pCode = code.code();
 
     VkShaderModule shaderModule;
     if(vkCreateShaderModule(this->device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS){
@@ -890,6 +1955,12 @@ VkShaderModule TriangleApplication::createShaderModule(const std::vector<char>&
 }
 
 void TriangleApplication::createRenderPass(){
+    // Dynamic rendering describes the attachment when recording instead
+    if(this->dynamicRenderingEnabled){
+        this->renderPass = VK_NULL_HANDLE;
+        return;
+    }
+
     VkAttachmentDescription colorAttachment = {};
     colorAttachment.format = this->swapChainImageFormat;
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -898,7 +1969,9 @@ void TriangleApplication::createRenderPass(){
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // Offscreen targets are left ready to be copied out instead of presented
+    colorAttachment.finalLayout = this->headless ?
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -931,15 +2004,88 @@ void TriangleApplication::createRenderPass(){
     if(vkCreateRenderPass(this->device, &renderPassInfo, nullptr, &this->renderPass) != VK_SUCCESS){
         throw std::runtime_error("Failed to create render pass!");
     }
+    this->renderTargetStats.renderPasses++;
 }
 
-// Set the output path of the shaders here
-const char* frag_shader = "shaders/triangle.frag.spv";
-const char* vert_shader = "shaders/triangle.vert.spv";
+// Shaders are looked up by source name, see ShaderLibrary
+const char* frag_shader = "triangle.frag";
+const char* vert_shader = "triangle.vert";
+const char* cull_shader = "cull.comp";
+
+// Specialization constant IDs declared in triangle.vert and triangle.frag
+const uint32_t instance_rotation_constant = 0;
+const uint32_t color_mode_constant = 1;
 
 void TriangleApplication::createGraphicsPipeline() {
-    auto fragShaderCode = readFile(frag_shader);
-    auto vertShaderCode = readFile(vert_shader);
+    // Per-draw transforms are pushed, per-frame data comes from the uniform ring
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(DrawCommand::transform);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &this->frameDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if(vkCreatePipelineLayout(this->device, &pipelineLayoutInfo, nullptr, &this->pipelineLayout) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+
+    // The pipeline itself compiles on a worker; frames skip drawing until it is ready
+    this->graphicsPipeline = this->getGraphicsVariant(this->graphicsVariant);
+}
+
+PipelineManager::Handle TriangleApplication::submitGraphicsPipeline(const ShaderVariant& variant, const std::vector<std::string>& recompile) {
+    VkRenderPass renderPass = this->renderPass;
+    VkFormat colorFormat = this->swapChainImageFormat;
+    VkPipelineLayout layout = this->pipelineLayout;
+    std::string sourceDirectory = this->shaderSourceDirectory;
+
+    return this->pipelineManager->submit([this, renderPass, colorFormat, layout, variant, recompile, sourceDirectory](VkPipelineCache cache){
+        for(const std::string& name : recompile){
+            this->shaderLibrary->compile(sourceDirectory, name);
+        }
+        return this->buildGraphicsPipeline(cache, renderPass, colorFormat, layout, variant);
+    });
+}
+
+ShaderVariant TriangleApplication::selectGraphicsVariant() const {
+    bool rotated = std::any_of(this->instances.begin(), this->instances.end(), [](const InstanceData& instance){
+        return instance.transform.w != 0.0f;
+    });
+
+    ShaderVariant variant;
+    variant.set(instance_rotation_constant, rotated);
+    variant.set(color_mode_constant, static_cast<uint32_t>(this->colorMode));
+    return variant;
+}
+
+PipelineManager::Handle TriangleApplication::getGraphicsVariant(const ShaderVariant& variant){
+    auto it = this->graphicsVariants.find(variant);
+    if(it != this->graphicsVariants.end()){
+        return it->second;
+    }
+
+    PipelineManager::Handle pipeline = this->submitGraphicsPipeline(variant, {});
+    this->graphicsVariants[variant] = pipeline;
+    this->graphicsVariantsBuilt++;
+    return pipeline;
+}
+
+void TriangleApplication::retireGraphicsVariants(){
+    for(const auto& entry : this->graphicsVariants){
+        this->retirePipeline(entry.second);
+    }
+    this->graphicsVariants.clear();
+    this->graphicsPipeline = 0;
+}
+
+VkPipeline TriangleApplication::buildGraphicsPipeline(VkPipelineCache cache, VkRenderPass renderPass, VkFormat colorFormat, VkPipelineLayout layout, const ShaderVariant& variant) {
+    ShaderBlob fragShaderCode = this->shaderLibrary->load(frag_shader);
+    ShaderBlob vertShaderCode = this->shaderLibrary->load(vert_shader);
 
     VkShaderModule vertShaderModule = this->createShaderModule(vertShaderCode);
     VkShaderModule fragShaderModule = this->createShaderModule(fragShaderCode);
@@ -950,21 +2096,35 @@ void TriangleApplication::createGraphicsPipeline() {
     vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main";
 
+    // Both stages share the variant; each ignores constants it does not declare
+    VkSpecializationInfo specializationInfo = variant.getSpecializationInfo();
+    vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     fragShaderStageInfo.module = fragShaderModule;
     fragShaderStageInfo.pName = "main";
+    fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
-    auto bindingDescription = TriangleApplication::Vertex::getBindingDescription();
-    auto attributeDescription = TriangleApplication::Vertex::getAttributeDescriptions();
+    // Binding 0 streams mesh vertices, binding 1 streams per-instance data
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {
+        Vertex::getBindingDescription(),
+        InstanceData::getBindingDescription()
+    };
+
+    auto vertexAttributes = Vertex::getAttributeDescriptions();
+    auto instanceAttributes = InstanceData::getAttributeDescriptions();
+
+    std::vector<VkVertexInputAttributeDescription> attributeDescription(vertexAttributes.begin(), vertexAttributes.end());
+    attributeDescription.insert(attributeDescription.end(), instanceAttributes.begin(), instanceAttributes.end());
 
     VkPipelineVertexInputStateCreateInfo vertexStateCreateInfo = {};
     vertexStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexStateCreateInfo.vertexBindingDescriptionCount = 1;
-    vertexStateCreateInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexStateCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+    vertexStateCreateInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size());
     vertexStateCreateInfo.pVertexAttributeDescriptions = attributeDescription.data();
 
@@ -973,24 +2133,13 @@ void TriangleApplication::createGraphicsPipeline() {
     inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport = {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = this->swapChainImageExtent.width;
-    viewport.height = this->swapChainImageExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {};
-    scissor.offset = {0, 0};
-    scissor.extent = this->swapChainImageExtent;
-
+    // Viewport and scissor are dynamic so the pipeline outlives swapchain resizes
     VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {};
     viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportStateCreateInfo.viewportCount = 1;
-    viewportStateCreateInfo.pViewports = &viewport;
+    viewportStateCreateInfo.pViewports = nullptr;
     viewportStateCreateInfo.scissorCount = 1;
-    viewportStateCreateInfo.pScissors = &scissor;
+    viewportStateCreateInfo.pScissors = nullptr;
 
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -1038,7 +2187,7 @@ void TriangleApplication::createGraphicsPipeline() {
 
     VkDynamicState dynamicStates[] = {
         VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_LINE_WIDTH
+        VK_DYNAMIC_STATE_SCISSOR
     };
 
     VkPipelineDynamicStateCreateInfo dynamicState = {};
@@ -1046,17 +2195,6 @@ void TriangleApplication::createGraphicsPipeline() {
     dynamicState.dynamicStateCount = 2;
     dynamicState.pDynamicStates = dynamicStates;
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-    if(vkCreatePipelineLayout(this->device, &pipelineLayoutInfo, nullptr, &this->pipelineLayout) != VK_SUCCESS){
-        throw std::runtime_error("Failed to create pipeline layout!");
-    }
-
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = 2;
@@ -1070,22 +2208,40 @@ void TriangleApplication::createGraphicsPipeline() {
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState; // Divergence from tutorial
     
-    pipelineInfo.layout = this->pipelineLayout;
-    pipelineInfo.renderPass = this->renderPass;
+    pipelineInfo.layout = layout;
+    pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
 
+    // Without a render pass the pipeline names its attachment format itself
+    VkPipelineRenderingCreateInfoKHR renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+    if(renderPass == VK_NULL_HANDLE){
+        pipelineInfo.pNext = &renderingInfo;
+    }
+
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    if(vkCreateGraphicsPipelines(this->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->graphicsPipeline) != VK_SUCCESS){
-        throw std::runtime_error("Failed to create graphics pipeline!");
-    }
+    VkPipeline pipeline;
+    VkResult result = vkCreateGraphicsPipelines(this->device, cache, 1, &pipelineInfo, nullptr, &pipeline);
 
     vkDestroyShaderModule(this->device, fragShaderModule, nullptr);
     vkDestroyShaderModule(this->device, vertShaderModule, nullptr);
+
+    if(result != VK_SUCCESS){
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+
+    return pipeline;
 }
 
 void TriangleApplication::createFrameBuffers(){
+    if(this->dynamicRenderingEnabled){
+        return;
+    }
+
     this->swapChainFramebuffers.resize(this->swapChainImageViews.size());
 
     for(size_t i = 0; i < this->swapChainImageViews.size(); i++){
@@ -1105,6 +2261,7 @@ void TriangleApplication::createFrameBuffers(){
         if(vkCreateFramebuffer(this->device, &framebufferInfo, nullptr, &this->swapChainFramebuffers[i]) != VK_SUCCESS){
             throw std::runtime_error("Failed to create framebuffer");
         }
+        this->renderTargetStats.framebuffers++;
     }
 }
 
@@ -1119,138 +2276,1214 @@ void TriangleApplication::createCommandPool(){
     if(vkCreateCommandPool(this->device, &poolInfo, nullptr, &this->commandPool) != VK_SUCCESS){
         throw std::runtime_error("Failed to create command pool");
     }
-}
 
-void TriangleApplication::createCommandBuffers(){
-    this->commandBuffers.resize(this->swapChainFramebuffers.size());
+    // Per-frame pools are reset wholesale once their frame's timeline value is reached
+    VkCommandPoolCreateInfo framePoolInfo = {};
+    framePoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    framePoolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    framePoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
-    VkCommandBufferAllocateInfo allocateInfo = {};
-    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocateInfo.commandPool = this->commandPool;
-    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocateInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+    this->frameCommandPools.resize(this->maxFramesInFlight);
+    for(size_t i = 0; i < this->frameCommandPools.size(); i++){
+        if(vkCreateCommandPool(this->device, &framePoolInfo, nullptr, &this->frameCommandPools[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to create frame command pool");
+        }
+    }
+
+    // Culling on the compute queue records from pools of that family
+    if(this->asyncCompute){
+        VkCommandPoolCreateInfo computePoolInfo = framePoolInfo;
+        computePoolInfo.queueFamilyIndex = this->computeQueueFamily;
+
+        this->computeCommandPools.resize(this->maxFramesInFlight);
+        for(size_t i = 0; i < this->computeCommandPools.size(); i++){
+            if(vkCreateCommandPool(this->device, &computePoolInfo, nullptr, &this->computeCommandPools[i]) != VK_SUCCESS){
+                throw std::runtime_error("Failed to create compute command pool");
+            }
+        }
+    }
 
-    if(vkAllocateCommandBuffers(this->device, &allocateInfo, this->commandBuffers.data()) != VK_SUCCESS){
-        throw std::runtime_error("Failed to allocate command buffers");
+    if(this->recordingThreads == 0){
+        return;
     }
 
-    for(size_t i = 0; i < this->commandBuffers.size(); i++){
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = 0;
-        beginInfo.pInheritanceInfo = nullptr;
+    // Command pools are externally synchronized, so every recording thread gets its own
+    this->recordingPool.reset(new ThreadPool(this->recordingThreads));
 
-        if(vkBeginCommandBuffer(this->commandBuffers[i], &beginInfo) != VK_SUCCESS){
-            throw std::runtime_error("Failed to begin recording command buffer");
+    this->secondaryCommandPools.resize(this->maxFramesInFlight);
+    for(size_t i = 0; i < this->secondaryCommandPools.size(); i++){
+        this->secondaryCommandPools[i].resize(this->recordingThreads);
+
+        for(size_t j = 0; j < this->secondaryCommandPools[i].size(); j++){
+            if(vkCreateCommandPool(this->device, &framePoolInfo, nullptr, &this->secondaryCommandPools[i][j]) != VK_SUCCESS){
+                throw std::runtime_error("Failed to create secondary command pool");
+            }
         }
+    }
+}
 
-        VkRenderPassBeginInfo renderPassInfo = {};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = this->renderPass;
-        renderPassInfo.framebuffer = this->swapChainFramebuffers[i];
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = this->swapChainImageExtent;
+void TriangleApplication::createCommandBuffers(){
+    this->frameCommandBuffers.resize(this->maxFramesInFlight);
 
-        VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues = &clearColor;
+    for(size_t i = 0; i < this->frameCommandBuffers.size(); i++){
+        VkCommandBufferAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = this->frameCommandPools[i];
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+
+        if(vkAllocateCommandBuffers(this->device, &allocateInfo, &this->frameCommandBuffers[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to allocate command buffers");
+        }
+    }
+
+    this->computeCommandBuffers.resize(this->computeCommandPools.size());
+    for(size_t i = 0; i < this->computeCommandPools.size(); i++){
+        VkCommandBufferAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = this->computeCommandPools[i];
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
 
-        vkCmdBeginRenderPass(this->commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(this->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, this->graphicsPipeline);
+        if(vkAllocateCommandBuffers(this->device, &allocateInfo, &this->computeCommandBuffers[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to allocate compute command buffers");
+        }
+    }
 
-        VkBuffer vertexBuffers[] = {this->vertexBuffer};
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffers[i], 0, 1, vertexBuffers, offsets);
+    this->secondaryCommandBuffers.resize(this->secondaryCommandPools.size());
+    for(size_t i = 0; i < this->secondaryCommandPools.size(); i++){
+        this->secondaryCommandBuffers[i].resize(this->secondaryCommandPools[i].size());
 
-        vkCmdDraw(this->commandBuffers[i], 3, 1, 0, 0);
+        for(size_t j = 0; j < this->secondaryCommandPools[i].size(); j++){
+            VkCommandBufferAllocateInfo allocateInfo = {};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandPool = this->secondaryCommandPools[i][j];
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocateInfo.commandBufferCount = 1;
 
-        vkCmdEndRenderPass(this->commandBuffers[i]);
-        if(vkEndCommandBuffer(this->commandBuffers[i]) != VK_SUCCESS){
-            throw std::runtime_error("Failed to record command buffer!");
+            if(vkAllocateCommandBuffers(this->device, &allocateInfo, &this->secondaryCommandBuffers[i][j]) != VK_SUCCESS){
+                throw std::runtime_error("Failed to allocate secondary command buffers");
+            }
         }
-    }  
+    }
 }
 
-void TriangleApplication::createVertexBuffers(){
-    VkBufferCreateInfo bufferInfo = {};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = sizeof(this->vertices[0]) * this->vertices.size();
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+void TriangleApplication::recordCommandBuffer(size_t frameIndex, uint32_t imageIndex){
+    VkCommandBuffer commandBuffer = this->frameCommandBuffers[frameIndex];
 
-    if(vkCreateBuffer(this->device, &bufferInfo, nullptr, &this->vertexBuffer) != VK_SUCCESS){
-        throw std::runtime_error("Failed to create vertex buffer");
+    if(vkResetCommandPool(this->device, this->frameCommandPools[frameIndex], 0) != VK_SUCCESS){
+        throw std::runtime_error("Failed to reset frame command pool");
     }
 
-    VkMemoryRequirements memoryRequirements;
-    vkGetBufferMemoryRequirements(this->device, this->vertexBuffer, &memoryRequirements);
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = nullptr;
 
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memoryRequirements.size;
-    allocInfo.memoryTypeIndex = this->findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if(vkAllocateMemory(this->device, &allocInfo, nullptr, &this->vertexBufferMemory) != VK_SUCCESS){
-        throw std::runtime_error("Failed to allocate vertex buffer memory.");
+    if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begin recording command buffer");
     }
 
-    vkBindBufferMemory(this->device, this->vertexBuffer, this->vertexBufferMemory, 0);
+    // Take over buffers uploaded since the last frame, possibly on the transfer queue
+    this->stagingWaitValue = this->stagingRing->acquire(commandBuffer);
 
-    void* data;
-    vkMapMemory(this->device, this->vertexBufferMemory, 0, bufferInfo.size, 0, &data);
-    memcpy(data, this->vertices.data(), (size_t) bufferInfo.size);
-    vkUnmapMemory(this->device, this->vertexBufferMemory);
-}
+    // Use whatever has finished compiling; until then the frame is only cleared
+    this->resolvePipelines();
 
-uint32_t TriangleApplication::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties){
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(this->physicalDevice, &memProperties);
+    bool drawsReady = this->activeGraphicsPipeline != VK_NULL_HANDLE &&
+        (!this->gpuCulling || this->activeCullPipeline != VK_NULL_HANDLE);
 
-    for(uint32_t i = 0; i < memProperties.memoryTypeCount; i++){
-        if (typeFilter & (1 << i) &&
-            (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-            return i;
+    // Culling runs before the render pass so its draw commands are ready for the indirect draw
+    this->computeSubmitPending = false;
+    if(this->gpuCulling && drawsReady){
+        if(this->asyncCompute){
+            this->recordAsyncCulling(commandBuffer, frameIndex);
+        }
+        else {
+            this->recordCulling(commandBuffer, frameIndex);
+        }
     }
 
-    throw std::runtime_error("Failed to find suitable memory type");
-}
+    uint32_t firstQuery = static_cast<uint32_t>(frameIndex) * 2;
+    if(this->gpuTimestampsSupported){
+        vkCmdResetQueryPool(commandBuffer, this->timestampQueryPool, firstQuery, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, this->timestampQueryPool, firstQuery);
+    }
 
-void TriangleApplication::createSyncObjects(){
-    this->imageAvailableSemaphores.resize(this->maxFramesInFlight);
-    this->renderFinishedSemaphores.resize(this->maxFramesInFlight);
-    this->inFlightFences.resize(this->maxFramesInFlight);
-    this->imagesInFlight.resize(this->swapChainImages.size(), VK_NULL_HANDLE);
+    if(!drawsReady){
+        this->beginRendering(commandBuffer, imageIndex, false);
+    }
+    else if(this->gpuCulling){
+        // A handful of indirect draws gains nothing from recording threads
+        this->beginRendering(commandBuffer, imageIndex, false);
+        this->recordIndirectDraws(commandBuffer, frameIndex);
+    }
+    else if(this->recordingThreads == 0){
+        this->beginRendering(commandBuffer, imageIndex, false);
+        this->recordDraws(commandBuffer, 0, this->drawList.size());
+    }
+    else {
+        this->beginRendering(commandBuffer, imageIndex, true);
 
-    VkSemaphoreCreateInfo semInfo = {};
-    semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        // Split the draw list into contiguous chunks, one per recording thread
+        size_t threadCount = this->secondaryCommandBuffers[frameIndex].size();
+        size_t chunkSize = (this->drawList.size() + threadCount - 1) / threadCount;
 
-    VkFenceCreateInfo fenceInfo = {};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        std::vector<std::future<void>> pending;
+        std::vector<VkCommandBuffer> secondaries;
+        for(size_t thread = 0; thread < threadCount; thread++){
+            size_t firstDraw = thread * chunkSize;
+            if(firstDraw >= this->drawList.size()){
+                break;
+            }
+            size_t drawCount = std::min(chunkSize, this->drawList.size() - firstDraw);
 
-    for(size_t i = 0; i < this->maxFramesInFlight; i++){
-        VkResult status1 = vkCreateSemaphore(this->device, &semInfo, nullptr, &this->imageAvailableSemaphores[i]);
-        VkResult status2 = vkCreateSemaphore(this->device, &semInfo, nullptr, &this->renderFinishedSemaphores[i]);
-        VkResult status3 = vkCreateFence(this->device, &fenceInfo, nullptr, &this->inFlightFences[i]);
-        
-        if(status1 != VK_SUCCESS || status2 != VK_SUCCESS || status3 != VK_SUCCESS){
-            throw std::runtime_error("Failed to create sync objects!");
+            pending.push_back(this->recordingPool->submit([this, frameIndex, thread, imageIndex, firstDraw, drawCount](){
+                this->recordSecondaryCommandBuffer(frameIndex, thread, imageIndex, firstDraw, drawCount);
+            }));
+            secondaries.push_back(this->secondaryCommandBuffers[frameIndex][thread]);
+        }
+
+        // Wait for every chunk before rethrowing, so no worker is still recording on failure
+        for(auto& task : pending){
+            task.wait();
+        }
+        for(auto& task : pending){
+            task.get();
+        }
+
+        if(!secondaries.empty()){
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
         }
     }
-}
 
-void TriangleApplication::destroyVkDebugMessenger(
-    const VkAllocationCallbacks* pAllocator
-){
-    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT) vkGetInstanceProcAddr(
-        this->vkInstance,
-        "vkDestroyDebugUtilsMessengerEXT"
-    );
+    this->endRendering(commandBuffer, imageIndex);
 
-    if (func != nullptr){
-        func(this->vkInstance, this->debugMessenger, pAllocator);
+    if(this->gpuTimestampsSupported){
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->timestampQueryPool, firstQuery + 1);
     }
-}
+
+    if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to record command buffer!");
+    }
+}
+
+void TriangleApplication::recordSecondaryCommandBuffer(size_t frameIndex, size_t threadIndex, uint32_t imageIndex, size_t firstDraw, size_t drawCount){
+    VkCommandBuffer commandBuffer = this->secondaryCommandBuffers[frameIndex][threadIndex];
+
+    if(vkResetCommandPool(this->device, this->secondaryCommandPools[frameIndex][threadIndex], 0) != VK_SUCCESS){
+        throw std::runtime_error("Failed to reset secondary command pool");
+    }
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = this->renderPass;
+    inheritanceInfo.subpass = 0;
+
+    // Under dynamic rendering the secondaries inherit the attachment formats instead
+    VkFormat colorFormat = this->swapChainImageFormat;
+    VkCommandBufferInheritanceRenderingInfoKHR renderingInheritance = {};
+    renderingInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    renderingInheritance.colorAttachmentCount = 1;
+    renderingInheritance.pColorAttachmentFormats = &colorFormat;
+    renderingInheritance.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    if(this->dynamicRenderingEnabled){
+        inheritanceInfo.pNext = &renderingInheritance;
+    }
+    else {
+        inheritanceInfo.framebuffer = this->swapChainFramebuffers[imageIndex];
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begin recording secondary command buffer");
+    }
+
+    this->recordDraws(commandBuffer, firstDraw, drawCount);
+
+    if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to record secondary command buffer!");
+    }
+}
+
+void TriangleApplication::beginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondaryCommandBuffers){
+    VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    VkRect2D renderArea = {};
+    renderArea.offset = {0, 0};
+    renderArea.extent = this->swapChainImageExtent;
+
+    if(!this->dynamicRenderingEnabled){
+        VkRenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = this->renderPass;
+        renderPassInfo.framebuffer = this->swapChainFramebuffers[imageIndex];
+        renderPassInfo.renderArea = renderArea;
+        renderPassInfo.clearValueCount = 1;
+        renderPassInfo.pClearValues = &clearColor;
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+            secondaryCommandBuffers ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    // Stands in for the render pass's initial layout and external dependency. The image is
+    // cleared, so its old contents are discarded; waiting on the color output stage chains
+    // with the acquire semaphore wait at that stage.
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = this->swapChainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier
+    );
+
+    VkRenderingAttachmentInfoKHR colorAttachment = {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    colorAttachment.imageView = this->swapChainImageViews[imageIndex];
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.clearValue = clearColor;
+
+    VkRenderingInfoKHR renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.flags = secondaryCommandBuffers ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+    renderingInfo.renderArea = renderArea;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+
+    this->cmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void TriangleApplication::endRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex){
+    if(!this->dynamicRenderingEnabled){
+        vkCmdEndRenderPass(commandBuffer);
+        return;
+    }
+
+    this->cmdEndRendering(commandBuffer);
+
+    // Same final layout as the render pass: presentable, or ready to be copied out when offscreen
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = this->headless ?
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = this->swapChainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier
+    );
+}
+
+void TriangleApplication::setViewportAndScissor(VkCommandBuffer commandBuffer){
+    VkViewport viewport = {};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(this->swapChainImageExtent.width);
+    viewport.height = static_cast<float>(this->swapChainImageExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.offset = {0, 0};
+    scissor.extent = this->swapChainImageExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void TriangleApplication::recordDraws(VkCommandBuffer commandBuffer, size_t firstDraw, size_t drawCount){
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->activeGraphicsPipeline);
+
+    // Dynamic state and bindings are not inherited, so every secondary sets them too
+    this->setViewportAndScissor(commandBuffer);
+    this->bindFrameResources(commandBuffer);
+
+    VkBuffer vertexBuffers[] = {this->vertexBuffer, this->instanceBuffer};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, this->indexBuffer, 0, this->indexType);
+
+    // Only push the transform when it differs from the previous draw's
+    const glm::vec4* pushedTransform = nullptr;
+    for(size_t i = firstDraw; i < firstDraw + drawCount; i++){
+        const DrawCommand& draw = this->drawList[i];
+        if(pushedTransform == nullptr || *pushedTransform != draw.transform){
+            vkCmdPushConstants(commandBuffer, this->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw.transform), &draw.transform);
+            pushedTransform = &draw.transform;
+        }
+        vkCmdDrawIndexed(commandBuffer, draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+    }
+}
+
+void TriangleApplication::recordCulling(VkCommandBuffer commandBuffer, size_t frameIndex){
+    VkBuffer drawBuffer = this->drawBuffers[frameIndex];
+
+    // Reset the draw count written by the previous use of this frame's buffer
+    vkCmdFillBuffer(commandBuffer, drawBuffer, 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier = {};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &clearBarrier,
+        0, nullptr,
+        0, nullptr
+    );
+
+    // Only compact when recordIndirectDraws will issue the count draw; every other
+    // path reads one slot per object and relies on culled slots drawing nothing
+    uint32_t objectCount = static_cast<uint32_t>(this->instances.size());
+    bool compact = this->drawIndirectCountSupported && objectCount <= this->maxDrawIndirectCount;
+
+    struct {
+        uint32_t objectCount;
+        uint32_t indexCount;
+        float boundingRadius;
+        uint32_t compact;
+        glm::vec4 viewMatrix;
+        glm::vec4 viewOffset;
+    } parameters = {
+        objectCount,
+        static_cast<uint32_t>(this->mesh.indices.size()),
+        this->mesh.getBoundingRadius(),
+        compact ? 1u : 0u,
+        this->frameUniforms.viewMatrix,
+        this->frameUniforms.viewOffset
+    };
+
+    // The set only lives for this frame, so it always sees the current instance buffer
+    VkDescriptorSet descriptorSet = this->descriptorAllocator->allocate(this->cullDescriptorSetLayout);
+
+    VkDescriptorBufferInfo instanceInfo = {};
+    instanceInfo.buffer = this->instanceBuffer;
+    instanceInfo.offset = 0;
+    instanceInfo.range = VK_WHOLE_SIZE;
+
+    VkDescriptorBufferInfo drawInfo = {};
+    drawInfo.buffer = drawBuffer;
+    drawInfo.offset = 0;
+    drawInfo.range = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 2> writes = {};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = descriptorSet;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[0].descriptorCount = 1;
+    writes[0].pBufferInfo = &instanceInfo;
+
+    writes[1] = writes[0];
+    writes[1].dstBinding = 1;
+    writes[1].pBufferInfo = &drawInfo;
+
+    vkUpdateDescriptorSets(this->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->activeCullPipeline);
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        this->cullPipelineLayout,
+        0, 1, &descriptorSet,
+        0, nullptr
+    );
+    vkCmdPushConstants(commandBuffer, this->cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(parameters), &parameters);
+
+    // One invocation per object, 64 per workgroup to match the shader
+    vkCmdDispatch(commandBuffer, (parameters.objectCount + 63) / 64, 1, 1);
+
+    // On the compute queue the draw buffer is released to the graphics family instead, which
+    // acquires it in recordAsyncCulling()
+    if(this->asyncCompute){
+        VkBufferMemoryBarrier release = {};
+        release.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        release.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        release.dstAccessMask = 0;
+        release.srcQueueFamilyIndex = this->computeQueueFamily;
+        release.dstQueueFamilyIndex = this->graphicsQueueFamily;
+        release.buffer = drawBuffer;
+        release.offset = 0;
+        release.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0, nullptr,
+            1, &release,
+            0, nullptr
+        );
+        return;
+    }
+
+    VkMemoryBarrier drawBarrier = {};
+    drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1, &drawBarrier,
+        0, nullptr,
+        0, nullptr
+    );
+}
+
+void TriangleApplication::recordAsyncCulling(VkCommandBuffer commandBuffer, size_t frameIndex){
+    VkCommandBuffer computeCommandBuffer = this->computeCommandBuffers[frameIndex];
+
+    if(vkResetCommandPool(this->device, this->computeCommandPools[frameIndex], 0) != VK_SUCCESS){
+        throw std::runtime_error("Failed to reset compute command pool");
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if(vkBeginCommandBuffer(computeCommandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begin recording compute command buffer");
+    }
+
+    this->recordCulling(computeCommandBuffer, frameIndex);
+
+    if(vkEndCommandBuffer(computeCommandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to record compute command buffer");
+    }
+    this->computeSubmitPending = true;
+
+    // Acquire the draw buffer released by the compute queue. The frame's submission waits for
+    // the compute semaphore at the same stage.
+    VkBufferMemoryBarrier acquire = {};
+    acquire.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    acquire.srcAccessMask = 0;
+    acquire.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    acquire.srcQueueFamilyIndex = this->computeQueueFamily;
+    acquire.dstQueueFamilyIndex = this->graphicsQueueFamily;
+    acquire.buffer = this->drawBuffers[frameIndex];
+    acquire.offset = 0;
+    acquire.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        0, nullptr,
+        1, &acquire,
+        0, nullptr
+    );
+}
+
+void TriangleApplication::submitCompute(size_t frameIndex){
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+    // Culling reads the instance buffer, whose upload may still be on the transfer queue
+    VkSemaphore waitSemaphore = this->stagingRing->getSemaphore();
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    submitInfo.waitSemaphoreCount = this->stagingWaitValue > 0 ? 1 : 0;
+    submitInfo.pWaitSemaphores = &waitSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &this->computeCommandBuffers[frameIndex];
+
+    uint64_t signalValue = this->frameScheduler->getFrameValue();
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &this->computeSemaphore;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = &this->stagingWaitValue;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+    submitInfo.pNext = &timelineInfo;
+
+    if(vkQueueSubmit(this->computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS){
+        throw std::runtime_error("Failed to submit culling to the compute queue");
+    }
+}
+
+void TriangleApplication::recordIndirectDraws(VkCommandBuffer commandBuffer, size_t frameIndex){
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->activeGraphicsPipeline);
+    this->setViewportAndScissor(commandBuffer);
+    this->bindFrameResources(commandBuffer);
+
+    // Culled draws all share the untransformed draw constants
+    glm::vec4 transform = DrawCommand{}.transform;
+    vkCmdPushConstants(commandBuffer, this->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(transform), &transform);
+
+    VkBuffer vertexBuffers[] = {this->vertexBuffer, this->instanceBuffer};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, this->indexBuffer, 0, this->indexType);
+
+    // Commands start after the 16 byte draw count header
+    VkBuffer drawBuffer = this->drawBuffers[frameIndex];
+    VkDeviceSize commandOffset = 16;
+    uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    uint32_t objectCount = static_cast<uint32_t>(this->instances.size());
+
+    if(this->drawIndirectCountSupported && objectCount <= this->maxDrawIndirectCount){
+        this->cmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, commandOffset, drawBuffer, 0, objectCount, stride);
+    }
+    else if(this->multiDrawIndirectSupported && objectCount <= this->maxDrawIndirectCount){
+        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, commandOffset, objectCount, stride);
+    }
+    else {
+        // Without multi-draw each slot is its own indirect draw, culled ones drawing nothing
+        for(uint32_t i = 0; i < objectCount; i++){
+            vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, commandOffset + i * stride, 1, stride);
+        }
+    }
+}
+
+void TriangleApplication::createQueryPool(){
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(this->physicalDevice, &deviceProperties);
+
+    QueueFamilyIndicies queueFamilyIndices = findQueueFamilies(this->physicalDevice);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(this->physicalDevice, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(this->physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    uint32_t validBits = queueFamilies[queueFamilyIndices.graphicsFamily.value()].timestampValidBits;
+
+    this->gpuTimestampsSupported = validBits > 0 && deviceProperties.limits.timestampPeriod > 0.0f;
+    this->timestampPeriod = deviceProperties.limits.timestampPeriod;
+    this->timestampMask = validBits >= 64 ? UINT64_MAX : ((uint64_t(1) << validBits) - 1);
+
+    this->timestampQueriesPending.assign(this->maxFramesInFlight, false);
+
+    if(!this->gpuTimestampsSupported){
+        if(this->verbose){
+            std::cout << "GPU timestamps are not supported on the graphics queue" << std::endl;
+        }
+        return;
+    }
+
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = static_cast<uint32_t>(this->maxFramesInFlight) * 2;
+
+    if(vkCreateQueryPool(this->device, &queryPoolInfo, nullptr, &this->timestampQueryPool) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create timestamp query pool");
+    }
+}
+
+bool TriangleApplication::collectGpuTimings(size_t frameIndex){
+    if(!this->gpuTimestampsSupported || !this->timestampQueriesPending[frameIndex]){
+        return false;
+    }
+
+    // Value/availability pairs for the begin and end timestamps; never blocks
+    uint64_t results[4] = {};
+    VkResult result = vkGetQueryPoolResults(
+        this->device,
+        this->timestampQueryPool,
+        static_cast<uint32_t>(frameIndex) * 2,
+        2,
+        sizeof(results),
+        results,
+        sizeof(uint64_t) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+    );
+
+    if(result != VK_SUCCESS || results[1] == 0 || results[3] == 0){
+        return false;
+    }
+
+    this->timestampQueriesPending[frameIndex] = false;
+
+    uint64_t ticks = (results[2] - results[0]) & this->timestampMask;
+    this->lastGpuRenderPassMs = static_cast<double>(ticks) * this->timestampPeriod / 1000000.0;
+    this->lastFrameTimings.gpuRenderPassMs = this->lastGpuRenderPassMs;
+
+    if(this->gpuTimingSampleCount == 0){
+        this->gpuTimingMin = this->lastGpuRenderPassMs;
+        this->gpuTimingMax = this->lastGpuRenderPassMs;
+    }
+    this->gpuTimingSum += this->lastGpuRenderPassMs;
+    this->gpuTimingMin = std::min(this->gpuTimingMin, this->lastGpuRenderPassMs);
+    this->gpuTimingMax = std::max(this->gpuTimingMax, this->lastGpuRenderPassMs);
+    this->gpuTimingSampleCount++;
+
+    if(this->gpuTimingLogInterval > 0 && this->gpuTimingSampleCount >= this->gpuTimingLogInterval){
+        if(this->verbose){
+            std::cout << "GPU render pass: avg " << this->gpuTimingSum / this->gpuTimingSampleCount <<
+                " ms, min " << this->gpuTimingMin << " ms, max " << this->gpuTimingMax <<
+                " ms over " << this->gpuTimingSampleCount << " frames" << std::endl;
+        }
+
+        this->gpuTimingSampleCount = 0;
+        this->gpuTimingSum = 0.0;
+    }
+
+    return true;
+}
+
+void TriangleApplication::createBuffer(
+    VkDeviceSize size,
+    VkBufferUsageFlags usage,
+    VkMemoryPropertyFlags properties,
+    VkBuffer& buffer,
+    Allocation& allocation,
+    bool shared
+){
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Shared buffers are used by several queue families at once, without ownership transfers
+    std::set<uint32_t> uniqueFamilies = {this->graphicsQueueFamily, this->computeQueueFamily, this->transferQueueFamily};
+    std::vector<uint32_t> queueFamilies(uniqueFamilies.begin(), uniqueFamilies.end());
+    if (shared && queueFamilies.size() > 1){
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+        bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+    }
+
+    this->memoryAllocator->createBuffer(bufferInfo, properties, buffer, allocation);
+}
+
+void TriangleApplication::createStagingRing(){
+    this->createBuffer(
+        this->stagingBufferSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        this->stagingBuffer,
+        this->stagingBufferAllocation
+    );
+
+    // The buffers it fills are drawn from on the graphics queue
+    this->stagingRing = std::make_unique<StagingRing>(
+        this->device,
+        this->transferQueue,
+        this->transferQueueFamily,
+        this->graphicsQueueFamily,
+        this->stagingBuffer,
+        this->stagingBufferAllocation.mappedData,
+        this->stagingBufferSize
+    );
+}
+
+void TriangleApplication::createFrameUniforms(){
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(this->physicalDevice, &deviceProperties);
+
+    // Each frame's region starts on the offset alignment, so dynamic offsets stay valid
+    VkDeviceSize alignment = deviceProperties.limits.minUniformBufferOffsetAlignment;
+    VkDeviceSize frameStride = UniformRing::frameStride(this->uniformRingFrameSize, alignment);
+
+    this->createBuffer(
+        frameStride * this->maxFramesInFlight,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        this->uniformBuffer,
+        this->uniformBufferAllocation
+    );
+
+    this->uniformRing = std::make_unique<UniformRing>(
+        this->uniformBuffer,
+        this->uniformBufferAllocation.mappedData,
+        alignment,
+        this->uniformRingFrameSize,
+        static_cast<uint32_t>(this->maxFramesInFlight)
+    );
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    this->frameDescriptorSetLayout = this->descriptorLayoutCache->get({binding});
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if(vkCreateDescriptorPool(this->device, &poolInfo, nullptr, &this->frameDescriptorPool) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create frame descriptor pool");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = this->frameDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &this->frameDescriptorSetLayout;
+
+    if(vkAllocateDescriptorSets(this->device, &allocInfo, &this->frameDescriptorSet) != VK_SUCCESS){
+        throw std::runtime_error("Failed to allocate frame descriptor set");
+    }
+
+    // Written once; frames select their data through the dynamic offset
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = this->uniformBuffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = sizeof(FrameUniforms);
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = this->frameDescriptorSet;
+    write.dstBinding = 0;
+    write.dstArrayElement = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.descriptorCount = 1;
+    write.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(this->device, 1, &write, 0, nullptr);
+}
+
+void TriangleApplication::destroyFrameUniforms(){
+    // Destroying the pool frees its descriptor set
+    vkDestroyDescriptorPool(this->device, this->frameDescriptorPool, nullptr);
+
+    this->uniformRing.reset();
+    this->memoryAllocator->destroyBuffer(this->uniformBuffer, this->uniformBufferAllocation);
+}
+
+void TriangleApplication::updateFrameUniforms(size_t frameIndex){
+    float c = std::cos(this->viewRotation) * this->viewZoom;
+    float s = std::sin(this->viewRotation) * this->viewZoom;
+
+    FrameUniforms& uniforms = this->frameUniforms;
+    uniforms.viewMatrix = glm::vec4(c, s, -s, c);
+    uniforms.viewOffset = glm::vec4(this->viewOffset, 0.0f, 0.0f);
+    uniforms.time = glm::vec4(
+        static_cast<float>(elapsedMilliseconds(this->initStart) / 1000.0),
+        static_cast<float>(this->frameCount),
+        0.0f, 0.0f
+    );
+
+    this->uniformRing->beginFrame(static_cast<uint32_t>(frameIndex));
+    this->frameUniformOffset = this->uniformRing->push(uniforms);
+}
+
+void TriangleApplication::bindFrameResources(VkCommandBuffer commandBuffer){
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        this->pipelineLayout,
+        0, 1, &this->frameDescriptorSet,
+        1, &this->frameUniformOffset
+    );
+}
+
+void TriangleApplication::createVertexBuffers(){
+    VkDeviceSize bufferSize = sizeof(this->mesh.vertices[0]) * this->mesh.vertices.size();
+
+    // Vertex fetch reads device-local memory; the data arrives through the staging ring
+    this->createBuffer(
+        bufferSize,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        this->vertexBuffer,
+        this->vertexBufferAllocation
+    );
+
+    this->stagingRing->uploadBuffer(this->vertexBuffer, 0, this->mesh.vertices.data(), bufferSize);
+    this->stagingRing->flush();
+}
+
+void TriangleApplication::createIndexBuffer(){
+    this->indexType = this->mesh.getIndexType();
+
+    // Narrow to 16-bit indices when the mesh allows it, halving index fetch bandwidth
+    std::vector<uint16_t> shortIndices;
+    const void* indexData = this->mesh.indices.data();
+    VkDeviceSize bufferSize = sizeof(uint32_t) * this->mesh.indices.size();
+
+    if (this->indexType == VK_INDEX_TYPE_UINT16){
+        shortIndices.assign(this->mesh.indices.begin(), this->mesh.indices.end());
+        indexData = shortIndices.data();
+        bufferSize = sizeof(uint16_t) * shortIndices.size();
+    }
+
+    this->createBuffer(
+        bufferSize,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        this->indexBuffer,
+        this->indexBufferAllocation
+    );
+
+    this->stagingRing->uploadBuffer(this->indexBuffer, 0, indexData, bufferSize);
+    this->stagingRing->flush();
+}
+
+void TriangleApplication::createInstanceBuffer(){
+    VkDeviceSize bufferSize = sizeof(this->instances[0]) * this->instances.size();
+
+    // Also read as a storage buffer by the culling pass, possibly on the compute queue
+    this->createBuffer(
+        bufferSize,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        this->instanceBuffer,
+        this->instanceBufferAllocation,
+        this->asyncCompute
+    );
+
+    this->stagingRing->uploadBuffer(this->instanceBuffer, 0, this->instances.data(), bufferSize, this->asyncCompute);
+    this->stagingRing->flush();
+}
+
+void TriangleApplication::createCullingPipeline(){
+    // Binding 0 reads the instances, binding 1 receives the draw count and commands
+    std::vector<VkDescriptorSetLayoutBinding> bindings(2);
+    for(uint32_t i = 0; i < bindings.size(); i++){
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    this->cullDescriptorSetLayout = this->descriptorLayoutCache->get(bindings);
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = 4 * sizeof(uint32_t) + 2 * sizeof(glm::vec4);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &this->cullDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if(vkCreatePipelineLayout(this->device, &pipelineLayoutInfo, nullptr, &this->cullPipelineLayout) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create culling pipeline layout");
+    }
+
+    this->cullPipeline = this->submitCullingPipeline({});
+}
+
+PipelineManager::Handle TriangleApplication::submitCullingPipeline(const std::vector<std::string>& recompile){
+    VkPipelineLayout layout = this->cullPipelineLayout;
+    std::string sourceDirectory = this->shaderSourceDirectory;
+
+    return this->pipelineManager->submit([this, layout, recompile, sourceDirectory](VkPipelineCache cache){
+        for(const std::string& name : recompile){
+            this->shaderLibrary->compile(sourceDirectory, name);
+        }
+        return this->buildCullingPipeline(cache, layout);
+    });
+}
+
+VkPipeline TriangleApplication::buildCullingPipeline(VkPipelineCache cache, VkPipelineLayout layout){
+    ShaderBlob cullShaderCode = this->shaderLibrary->load(cull_shader);
+    VkShaderModule cullShaderModule = this->createShaderModule(cullShaderCode);
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = cullShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = layout;
+
+    VkPipeline pipeline;
+    VkResult result = vkCreateComputePipelines(this->device, cache, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(this->device, cullShaderModule, nullptr);
+
+    if(result != VK_SUCCESS){
+        throw std::runtime_error("Failed to create culling pipeline");
+    }
+
+    return pipeline;
+}
+
+void TriangleApplication::createDrawBuffers(){
+    // 16 byte count header followed by one command slot per instance
+    VkDeviceSize bufferSize = 16 + sizeof(VkDrawIndexedIndirectCommand) * this->instances.size();
+
+    this->drawBuffers.resize(this->maxFramesInFlight);
+    this->drawBufferAllocations.resize(this->maxFramesInFlight);
+
+    for(size_t i = 0; i < this->maxFramesInFlight; i++){
+        this->createBuffer(
+            bufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            this->drawBuffers[i],
+            this->drawBufferAllocations[i]
+        );
+    }
+}
+
+void TriangleApplication::destroyDrawBuffers(){
+    for(size_t i = 0; i < this->drawBuffers.size(); i++){
+        this->memoryAllocator->destroyBuffer(this->drawBuffers[i], this->drawBufferAllocations[i]);
+    }
+    this->drawBuffers.clear();
+    this->drawBufferAllocations.clear();
+}
+
+void TriangleApplication::createShaderWatcher(){
+    if(this->shaderLibrary->getSource() == ShaderLibrary::Source::Embedded){
+        std::cerr << "Shader hot reload is unavailable with shaders embedded in the executable" << std::endl;
+        return;
+    }
+
+    // Watch the GLSL when it can be recompiled, otherwise the SPIR-V the pipelines load
+    std::string directory = this->shaderSourceDirectory.empty() ? this->shaderLibrary->getDirectory() : this->shaderSourceDirectory;
+    this->shaderWatcher = std::make_unique<ShaderWatcher>(directory);
+
+    if(this->verbose){
+        std::cout << "Watching " << directory << " for shader changes" << std::endl;
+    }
+}
+
+void TriangleApplication::reloadChangedShaders(){
+    if(!this->shaderWatcher){
+        return;
+    }
+
+    std::set<std::string> changed = this->shaderWatcher->poll();
+    if(changed.empty()){
+        return;
+    }
+
+    std::vector<std::string> graphicsShaders;
+    std::vector<std::string> cullShaders;
+    for(const std::string& name : changed){
+        if(name == vert_shader || name == frag_shader){
+            graphicsShaders.push_back(name);
+        }
+        else if(name == cull_shader){
+            cullShaders.push_back(name);
+        }
+    }
+
+    // Only GLSL needs compiling; changed SPIR-V is picked up by the rebuild directly
+    bool compileSources = !this->shaderSourceDirectory.empty();
+
+    // A newer edit supersedes any rebuild still in progress
+    if(!graphicsShaders.empty()){
+        if(this->pendingGraphicsPipeline != 0){
+            this->retirePipeline(this->pendingGraphicsPipeline);
+        }
+        this->pendingGraphicsPipeline = this->submitGraphicsPipeline(this->graphicsVariant, compileSources ? graphicsShaders : std::vector<std::string>());
+        this->pendingGraphicsVariant = this->graphicsVariant;
+    }
+    if(!cullShaders.empty() && this->gpuCulling){
+        if(this->pendingCullPipeline != 0){
+            this->retirePipeline(this->pendingCullPipeline);
+        }
+        this->pendingCullPipeline = this->submitCullingPipeline(compileSources ? cullShaders : std::vector<std::string>());
+    }
+
+    if(this->verbose){
+        for(const std::string& name : changed){
+            std::cout << "Reloading shader " << name << std::endl;
+        }
+    }
+}
+
+void TriangleApplication::resolvePipelines(){
+    // A reload replaces every variant, since they were all built from the old shaders
+    PipelineManager::Handle reloaded = this->takeReloadedPipeline(this->pendingGraphicsPipeline);
+    if(reloaded != 0){
+        this->retireGraphicsVariants();
+        this->graphicsVariants[this->pendingGraphicsVariant] = reloaded;
+    }
+
+    // Switch to the requested variant once it has compiled, drawing with the previous one
+    // until then
+    PipelineManager::Handle requested = this->getGraphicsVariant(this->graphicsVariant);
+    VkPipeline pipeline = this->pipelineManager->tryGet(requested);
+    if(pipeline != VK_NULL_HANDLE || this->graphicsPipeline == 0){
+        this->graphicsPipeline = requested;
+        this->activeGraphicsPipeline = pipeline;
+    }
+    else {
+        this->activeGraphicsPipeline = this->pipelineManager->tryGet(this->graphicsPipeline);
+    }
+
+    if(this->gpuCulling){
+        reloaded = this->takeReloadedPipeline(this->pendingCullPipeline);
+        if(reloaded != 0){
+            this->retirePipeline(this->cullPipeline);
+            this->cullPipeline = reloaded;
+        }
+        this->activeCullPipeline = this->pipelineManager->tryGet(this->cullPipeline);
+    }
+    else {
+        this->activeCullPipeline = VK_NULL_HANDLE;
+    }
+}
+
+PipelineManager::Handle TriangleApplication::takeReloadedPipeline(PipelineManager::Handle& pending){
+    if(pending == 0){
+        return 0;
+    }
+
+    VkPipeline pipeline;
+    try {
+        pipeline = this->pipelineManager->tryGet(pending);
+    }
+    catch (std::exception &ex) {
+        // Keep drawing with the previous pipeline until the shader is fixed
+        std::cerr << "Shader reload failed: " << ex.what() << std::endl;
+        this->retirePipeline(pending);
+        pending = 0;
+        return 0;
+    }
+
+    if(pipeline == VK_NULL_HANDLE){
+        return 0;
+    }
+
+    PipelineManager::Handle reloaded = pending;
+    pending = 0;
+    return reloaded;
+}
+
+void TriangleApplication::retirePipeline(PipelineManager::Handle pipeline){
+    // Submitted frames and the one being recorded may reference the pipeline
+    this->retiredPipelines.push_back({this->frameScheduler->getSubmittedValue() + 1, pipeline});
+}
+
+void TriangleApplication::releaseRetiredPipelines(uint64_t completedValue){
+    // Builds that are still compiling stay queued rather than blocking the frame on them
+    for(auto it = this->retiredPipelines.begin(); it != this->retiredPipelines.end() && it->releaseValue <= completedValue;){
+        if(this->pipelineManager->isReady(it->pipeline)){
+            this->pipelineManager->destroy(it->pipeline);
+            it = this->retiredPipelines.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void TriangleApplication::createSyncObjects(){
+    this->frameScheduler = std::make_unique<FrameScheduler>(this->device, static_cast<uint32_t>(this->maxFramesInFlight));
+
+    // Culling on the compute queue signals the value of the frame it belongs to
+    if(this->asyncCompute){
+        VkSemaphoreTypeCreateInfo typeInfo = {};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo computeSemInfo = {};
+        computeSemInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        computeSemInfo.pNext = &typeInfo;
+
+        if(vkCreateSemaphore(this->device, &computeSemInfo, nullptr, &this->computeSemaphore) != VK_SUCCESS){
+            throw std::runtime_error("Failed to create sync objects!");
+        }
+    }
+
+    // Offscreen frames are paced by the timeline alone
+    if(this->headless){
+        return;
+    }
+
+    VkSemaphoreCreateInfo semInfo = {};
+    semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    this->imageAvailableSemaphores.resize(this->maxFramesInFlight);
+    for(size_t i = 0; i < this->maxFramesInFlight; i++){
+        if(vkCreateSemaphore(this->device, &semInfo, nullptr, &this->imageAvailableSemaphores[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to create sync objects!");
+        }
+    }
+
+    this->createRenderFinishedSemaphores();
+}
+
+void TriangleApplication::createRenderFinishedSemaphores(){
+    // A present may still be waiting on an image's semaphore when another frame slot comes
+    // around, so these follow the swapchain images rather than the frame slots
+    VkSemaphoreCreateInfo semInfo = {};
+    semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    this->renderFinishedSemaphores.resize(this->swapChainImages.size());
+    for(size_t i = 0; i < this->renderFinishedSemaphores.size(); i++){
+        if(vkCreateSemaphore(this->device, &semInfo, nullptr, &this->renderFinishedSemaphores[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to create sync objects!");
+        }
+    }
+}
+
+void TriangleApplication::destroyVkDebugMessenger(
+    const VkAllocationCallbacks* pAllocator
+){
+    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT) vkGetInstanceProcAddr(
+        this->vkInstance,
+        "vkDestroyDebugUtilsMessengerEXT"
+    );
+
+    if (func != nullptr){
+        func(this->vkInstance, this->debugMessenger, pAllocator);
+    }
+}
 
 VKAPI_ATTR VkBool32 VKAPI_CALL TriangleApplication::debugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -1261,4 +3494,4 @@ VKAPI_ATTR VkBool32 VKAPI_CALL TriangleApplication::debugCallback(
     std::cerr << "Validation Layer: " << pCallbackData->pMessage << std::endl;
 
     return VK_FALSE;
-}
\ No newline at end of file
+}
@@ -0,0 +1,74 @@
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <uniform_ring.hpp>
+
+using namespace triangle;
+
+namespace {
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment){
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+UniformRing::UniformRing(
+    VkBuffer buffer,
+    void* mappedData,
+    VkDeviceSize alignment,
+    VkDeviceSize frameCapacity,
+    uint32_t frameCount
+) {
+    if (mappedData == nullptr){
+        throw std::invalid_argument("The uniform ring needs a persistently mapped buffer");
+    }
+    if (frameCount == 0){
+        throw std::invalid_argument("The uniform ring needs at least one frame");
+    }
+
+    this->buffer = buffer;
+    this->mappedData = static_cast<char*>(mappedData);
+    // The limit is a power of two, but may be reported as 0 by some drivers
+    this->alignment = std::max<VkDeviceSize>(alignment, 1);
+    this->stride = frameStride(frameCapacity, this->alignment);
+    this->frameCount = frameCount;
+
+    this->frameStart = 0;
+    this->head = 0;
+
+    this->stats.frameCapacity = this->stride;
+}
+
+VkDeviceSize UniformRing::frameStride(VkDeviceSize frameCapacity, VkDeviceSize alignment) {
+    return alignUp(frameCapacity, std::max<VkDeviceSize>(alignment, 1));
+}
+
+void UniformRing::beginFrame(uint32_t frameIndex) {
+    if (frameIndex >= this->frameCount){
+        throw std::out_of_range("Uniform ring frame index out of range");
+    }
+
+    this->frameStart = frameIndex * this->stride;
+    this->head = 0;
+}
+
+uint32_t UniformRing::push(const void* data, VkDeviceSize size) {
+    VkDeviceSize offset = alignUp(this->head, this->alignment);
+    if (offset + size > this->stride){
+        throw std::runtime_error("Uniform ring frame capacity exceeded");
+    }
+
+    std::memcpy(this->mappedData + this->frameStart + offset, data, static_cast<size_t>(size));
+
+    this->head = offset + size;
+    this->stats.peakFrameBytes = std::max(this->stats.peakFrameBytes, this->head);
+
+    return static_cast<uint32_t>(this->frameStart + offset);
+}
+
+VkBuffer UniformRing::getBuffer() const {
+    return this->buffer;
+}
+
+UniformRing::Stats UniformRing::getStats() const {
+    return this->stats;
+}